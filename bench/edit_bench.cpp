@@ -0,0 +1,90 @@
+// Micro-benchmark: node edits on a large profile (edits/s).
+// Runs thousands of inserts, local moves, far moves and removes on a
+// 100k-node MotorProfile, and compares the move against the previous
+// approach (assign, then std::sort the whole vector).
+#include "core/motionmodels.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <QtGlobal>
+#include <algorithm> // std::is_sorted
+#include <random>
+
+static const int NODE_COUNT = 100000;
+static const int EDIT_COUNT = 5000;
+static const double NODE_SPACING = 10.0; // ms
+
+static void report(QTextStream& out, const char* name, qint64 ns, int edits) {
+    out << name << ": " << double(ns) / edits / 1000.0 << " us/edit, "
+        << edits / (ns * 1e-9) << " edits/s\n";
+}
+
+int main() {
+    QTextStream out(stdout);
+
+    QVector<MotionNode> nodes;
+    nodes.reserve(NODE_COUNT);
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        nodes.append(MotionNode(i * NODE_SPACING, (i % 7) * 10.0 - 30.0));
+    }
+    MotorProfile profile("bench", Qt::red);
+    profile.setNodes(nodes);
+    const double endTime = profile.nodes().last().x();
+    out << "nodes: " << NODE_COUNT << ", edits per run: " << EDIT_COUNT << "\n";
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> anyTime(0.0, endTime);
+    std::uniform_real_distribution<double> nudge(-3.0 * NODE_SPACING, 3.0 * NODE_SPACING);
+    std::uniform_real_distribution<double> anyValue(-50.0, 50.0);
+    std::uniform_int_distribution<int> anyIndex(0, NODE_COUNT - 1);
+
+    QElapsedTimer timer;
+
+    // Inserts at random times (binary-search position + shift)
+    QVector<quint32> inserted;
+    timer.start();
+    for (int i = 0; i < EDIT_COUNT; ++i) {
+        int index = profile.internalAddNode(MotionNode(anyTime(rng), anyValue(rng)));
+        inserted.append(profile.nodeId(index));
+    }
+    report(out, "insert", timer.nsecsElapsed(), EDIT_COUNT);
+
+    // Drag-like moves: a few neighbours left or right
+    timer.start();
+    for (int i = 0; i < EDIT_COUNT; ++i) {
+        int index = anyIndex(rng);
+        MotionNode node = profile.nodeAt(index);
+        profile.internalMoveNode(index, MotionNode(qMax(0.0, node.x() + nudge(rng)), node.y()));
+    }
+    report(out, "local move", timer.nsecsElapsed(), EDIT_COUNT);
+
+    // Moves to anywhere on the time axis
+    timer.start();
+    for (int i = 0; i < EDIT_COUNT; ++i) {
+        profile.internalMoveNode(anyIndex(rng), MotionNode(anyTime(rng), anyValue(rng)));
+    }
+    report(out, "far move", timer.nsecsElapsed(), EDIT_COUNT);
+
+    // Removes by ID, as the undo commands do
+    timer.start();
+    for (quint32 id : inserted) {
+        profile.internalRemoveNode(profile.indexOfNode(id));
+    }
+    report(out, "remove by id", timer.nsecsElapsed(), inserted.size());
+
+    // Previous approach, for reference: assign, then full std::sort
+    QVector<MotionNode> reference = profile.nodes();
+    const int sortEdits = EDIT_COUNT / 10; // Much slower; fewer runs
+    timer.start();
+    for (int i = 0; i < sortEdits; ++i) {
+        int index = anyIndex(rng);
+        MotionNode node = reference[index];
+        reference[index] = MotionNode(qMax(0.0, node.x() + nudge(rng)), node.y());
+        sortMotionNodes(reference);
+    }
+    report(out, "local move (full sort)", timer.nsecsElapsed(), sortEdits);
+
+    bool sorted = std::is_sorted(profile.nodes().constBegin(), profile.nodes().constEnd(), motionNodeLess);
+    out << "profile " << (sorted ? "sorted" : "NOT SORTED") << ", " << profile.nodeCount() << " nodes\n";
+    return sorted ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+// Micro-benchmark: YAML sample formatting throughput (MB/s).
+// Compares QTextStream + QString::number(x, 'g', 10) against YamlWriter
+// (std::to_chars into a reused buffer) and checks the output is byte-identical.
+#include "core/yamlwriter.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <qmath.h>
+
+static const int SAMPLE_COUNT = 1000000;
+static const int REPEATS = 3;
+
+template <typename Fn>
+static qint64 bestOf(Fn fn) {
+    qint64 best = -1;
+    for (int r = 0; r < REPEATS; ++r) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        qint64 ns = timer.nsecsElapsed();
+        if (best < 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main() {
+    QTextStream out(stdout);
+
+    // Sample-like data: times on a 0.1 ms grid, values from a sine sweep
+    QVector<double> times(SAMPLE_COUNT);
+    QVector<double> values(SAMPLE_COUNT);
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        times[i] = i * 0.1;
+        values[i] = 80.0 * qSin(i * 0.001) + 0.123456789 * (i % 13);
+    }
+
+    QByteArray textStreamBytes;
+    qint64 textStreamNs = bestOf([&]() {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QTextStream ts(&buffer);
+        ts.setCodec("UTF-8");
+        ts << "    - [";
+        for (int i = 0; i < SAMPLE_COUNT; ++i) {
+            if (i > 0) ts << ", ";
+            ts << "[" << QString::number(times[i], 'g', 10) << ", " << QString::number(values[i], 'g', 10) << "]";
+        }
+        ts << "]\n";
+        ts.flush();
+        textStreamBytes = buffer.data();
+    });
+
+    QByteArray writerBytes;
+    qint64 writerNs = bestOf([&]() {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        {
+            YamlWriter writer(&buffer);
+            writer.write("    - [");
+            for (int i = 0; i < SAMPLE_COUNT; ++i) {
+                if (i > 0) writer.write(", ");
+                writer.write("[").writeNumber(times[i]).write(", ").writeNumber(values[i]).write("]");
+            }
+            writer.write("]\n");
+        }
+        writerBytes = buffer.data();
+    });
+
+    const double megabytes = textStreamBytes.size() / (1024.0 * 1024.0);
+    out << "samples: " << SAMPLE_COUNT << ", output: " << megabytes << " MB\n";
+    out << "QTextStream + QString::number: " << megabytes / (textStreamNs * 1e-9) << " MB/s\n";
+    out << "YamlWriter (std::to_chars):    " << megabytes / (writerNs * 1e-9) << " MB/s\n";
+    out << "output " << (textStreamBytes == writerBytes ? "identical" : "DIFFERS") << "\n";
+    return textStreamBytes == writerBytes ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Micro-benchmark: dense linear sampling throughput (samples/s).
+// Compares the per-sample MotorProfile::sampleAt loop against
+// MotorProfile::sampleRange with each available interpolation kernel.
+#include "core/motionmodels.h"
+#include "core/interpkernel.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <cstring> // memcmp
+
+static const int NODE_COUNT = 2000;
+static const int SAMPLE_COUNT = 4000000;
+static const int REPEATS = 5;
+
+// Best-of-N wall time in nanoseconds
+template <typename Fn>
+static qint64 bestOf(Fn fn) {
+    qint64 best = -1;
+    for (int r = 0; r < REPEATS; ++r) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        qint64 ns = timer.nsecsElapsed();
+        if (best < 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main() {
+    QTextStream out(stdout);
+
+    MotorProfile profile("bench", Qt::red);
+    QVector<MotionNode> nodes;
+    for (int i = 0; i < NODE_COUNT; ++i) {
+        nodes.append(MotionNode(i * 30.0, (i % 7) * 10.0 - 30.0));
+    }
+    profile.setNodes(nodes);
+    const double endTime = profile.nodes().last().x();
+    const double dt = endTime / SAMPLE_COUNT;
+
+    QVector<double> reference(SAMPLE_COUNT);
+    QVector<double> values(SAMPLE_COUNT);
+
+    out << "nodes: " << NODE_COUNT << ", samples: " << SAMPLE_COUNT << "\n";
+
+    qint64 ns = bestOf([&]() {
+        for (int i = 0; i < SAMPLE_COUNT; ++i) reference[i] = profile.sampleAt(i * dt);
+    });
+    out << qSetFieldWidth(24) << left << "sampleAt loop" << qSetFieldWidth(0)
+        << (SAMPLE_COUNT / (ns * 1e-9)) / 1e6 << " Msamples/s\n";
+
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX };
+    for (SimdLevel level : levels) {
+        if (!setActiveSimdLevel(level)) continue;
+        ns = bestOf([&]() { profile.sampleRange(0.0, dt, SAMPLE_COUNT, values.data()); });
+        bool same = std::memcmp(values.constData(), reference.constData(), SAMPLE_COUNT * sizeof(double)) == 0;
+        out << qSetFieldWidth(24) << left << (QString("sampleRange/") + simdLevelName(level)) << qSetFieldWidth(0)
+            << (SAMPLE_COUNT / (ns * 1e-9)) / 1e6 << " Msamples/s"
+            << (same ? "" : "  (MISMATCH vs sampleAt)") << "\n";
+    }
+    setActiveSimdLevel(detectSimdLevel());
+    return 0;
+}
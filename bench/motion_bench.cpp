@@ -0,0 +1,353 @@
+// Benchmark suite: the editor's hot paths on synthetic documents.
+// Times sampling, YAML parsing/loading, YAML saving, binary saving/loading
+// (after checking the binary round trip), sample export and the scene
+// rebuild on N motors x M nodes, counts heap allocations per operation and
+// writes the results as JSON (stdout or --json <file>), e.g.
+//   motion_bench --motors 8 --nodes 100000 --json results.json
+#include "core/motionmodels.h"
+#include "core/documentio.h"
+#include "core/binaryformat.h"
+#include "core/sampleexporter.h"
+#include "core/grapheditorview.h"
+#include <QApplication>
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <atomic>
+#include <cerrno>  // ENOMEM
+#include <cstdlib> // malloc, free
+#include <new>
+#include <random>
+
+// --- Allocation counting ---
+// The counters are read before and after one run of a benchmark. Qt's
+// containers allocate with malloc/realloc (not operator new), so on glibc
+// the C allocator itself is interposed; that also sees every operator new,
+// which libstdc++ implements on top of malloc. A realloc counts as one
+// allocation of its new size. Elsewhere only operator new can be counted,
+// and the JSON says so ("allocation_counter").
+static std::atomic<qint64> g_allocations(0);
+static std::atomic<qint64> g_allocatedBytes(0);
+
+static inline void countAllocation(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(qint64(size), std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+static const char* const ALLOCATION_COUNTER = "malloc";
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+void* malloc(std::size_t size) {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) {
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+    countAllocation(size);
+    return __libc_realloc(p, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) {
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) {
+    countAllocation(size);
+    *result = __libc_memalign(alignment, size);
+    return *result ? 0 : ENOMEM;
+}
+}
+#else
+static const char* const ALLOCATION_COUNTER = "operator_new";
+
+void* operator new(std::size_t size) {
+    countAllocation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+/**
+ * @brief Result of one benchmark: best wall time over the repeats, and the
+ * allocations of a single run.
+ */
+struct BenchResult {
+    QString name;
+    qint64 ops = 0;            // Operations per run
+    qint64 bytes = 0;          // Bytes processed per run (0 if not meaningful)
+    qint64 bestNs = 0;
+    qint64 allocations = 0;
+    qint64 allocatedBytes = 0;
+};
+
+template <typename Fn>
+static BenchResult runBench(const QString& name, qint64 ops, qint64 bytes, int repeats, Fn fn) {
+    BenchResult result;
+    result.name = name;
+    result.ops = ops;
+    result.bytes = bytes;
+    result.bestNs = -1;
+    for (int r = 0; r < repeats; ++r) {
+        const qint64 allocationsBefore = g_allocations.load();
+        const qint64 bytesBefore = g_allocatedBytes.load();
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        const qint64 ns = timer.nsecsElapsed();
+        result.allocations = g_allocations.load() - allocationsBefore;
+        result.allocatedBytes = g_allocatedBytes.load() - bytesBefore;
+        if (result.bestNs < 0 || ns < result.bestNs) result.bestNs = ns;
+    }
+    return result;
+}
+
+static QJsonObject toJson(const BenchResult& result) {
+    QJsonObject object;
+    object["name"] = result.name;
+    object["ops"] = result.ops;
+    object["best_ns"] = result.bestNs;
+    object["ns_per_op"] = double(result.bestNs) / qMax<qint64>(result.ops, 1);
+    object["ops_per_s"] = result.ops / (qMax<qint64>(result.bestNs, 1) * 1e-9);
+    if (result.bytes > 0) {
+        object["bytes"] = result.bytes;
+        object["mb_per_s"] = result.bytes / (1024.0 * 1024.0) / (qMax<qint64>(result.bestNs, 1) * 1e-9);
+    }
+    object["allocations_per_op"] = double(result.allocations) / qMax<qint64>(result.ops, 1);
+    object["allocated_bytes_per_op"] = double(result.allocatedBytes) / qMax<qint64>(result.ops, 1);
+    return object;
+}
+
+// Synthetic document: 'motors' profiles of 'nodes' nodes each, 10 ms apart,
+// with a seeded random walk so every run sees the same data
+static MotionDocumentData makeDocument(int motors, int nodes) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> step(-5.0, 5.0);
+    MotionDocumentData data;
+    data.id = "bench";
+    for (int m = 0; m < motors; ++m) {
+        MotorData motor;
+        motor.name = QString("motor_%1").arg(m);
+        motor.yMin = -100.0;
+        motor.yMax = 100.0;
+        motor.nodes.reserve(nodes);
+        double y = 0.0;
+        for (int n = 0; n < nodes; ++n) {
+            y = qBound(-100.0, y + step(rng), 100.0);
+            motor.nodes.append(MotionNode(n * 10.0, y));
+        }
+        data.motors.append(motor);
+    }
+    return data;
+}
+
+// Exact comparison (QPointF's operator== is fuzzy)
+static bool sameDocument(const MotionDocumentData& a, const MotionDocumentData& b) {
+    if (a.id != b.id || a.motors.size() != b.motors.size()) return false;
+    for (int m = 0; m < a.motors.size(); ++m) {
+        const MotorData& x = a.motors[m];
+        const MotorData& y = b.motors[m];
+        if (x.name != y.name || x.color != y.color || x.yMin != y.yMin || x.yMax != y.yMax
+            || x.maxSlope != y.maxSlope || x.interpolation != y.interpolation || x.nodes.size() != y.nodes.size()) {
+            return false;
+        }
+        for (int n = 0; n < x.nodes.size(); ++n) {
+            if (x.nodes[n].x() != y.nodes[n].x() || x.nodes[n].y() != y.nodes[n].y()) return false;
+        }
+    }
+    return true;
+}
+
+// Writes 'data' to 'filename' and reads it back; false if the read fails
+static bool binaryRoundTrip(const QString& filename, const MotionDocumentData& data, MotionDocumentData* read, QString* error) {
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+    bool ok = writeBinaryDocument(&file, data, error);
+    file.close();
+    return ok && readBinaryDocument(filename, read, error);
+}
+
+int main(int argc, char* argv[]) {
+    // The scene benchmark needs a widget, but never a screen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times the motion editor's hot paths on synthetic documents.");
+    parser.addHelpOption();
+    QCommandLineOption motorsOption("motors", "Motors per document (default 4).", "n", "4");
+    QCommandLineOption nodesOption("nodes", "Nodes per motor (default 20000).", "n", "20000");
+    QCommandLineOption repeatsOption("repeats", "Runs per benchmark; the best is reported (default 5).", "n", "5");
+    QCommandLineOption jsonOption("json", "Write the JSON results to a file instead of stdout.", "file");
+    parser.addOption(motorsOption);
+    parser.addOption(nodesOption);
+    parser.addOption(repeatsOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+    const int motorCount = qMax(1, parser.value(motorsOption).toInt());
+    const int nodeCount = qMax(2, parser.value(nodesOption).toInt());
+    const int repeats = qMax(1, parser.value(repeatsOption).toInt());
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qWarning() << "Cannot create a temporary directory";
+        return 1;
+    }
+    const QString yamlFile = tempDir.filePath("bench.yaml");
+    const MotionDocumentData data = makeDocument(motorCount, nodeCount);
+    const qint64 totalNodes = qint64(motorCount) * nodeCount;
+    QVector<BenchResult> results;
+
+    MotionDocument document;
+    document.loadData(data);
+    if (!document.saveToYAML(yamlFile, data.id)) return 1;
+    const qint64 yamlBytes = QFileInfo(yamlFile).size();
+
+    // Random access sampling on one profile
+    {
+        MotorProfile* profile = document.motorProfiles().first();
+        const double endTime = profile->nodes().last().x();
+        const int samples = 1000000;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> anyTime(0.0, endTime);
+        QVector<double> times(samples);
+        for (double& t : times) t = anyTime(rng);
+        volatile double sink = 0.0;
+        results.append(runBench("sample_at_random", samples, 0, repeats, [&]() {
+            double sum = 0.0;
+            for (double t : times) sum += profile->sampleAt(t);
+            sink = sum;
+        }));
+        QVector<double> values(samples);
+        results.append(runBench("sample_range", samples, 0, repeats, [&]() {
+            profile->sampleRange(0.0, endTime / samples, samples, values.data());
+        }));
+        Q_UNUSED(sink);
+    }
+
+    // YAML parse only, then the full load into a document (no view attached)
+    results.append(runBench("yaml_parse", totalNodes, yamlBytes, repeats, [&]() {
+        readDocumentFile(yamlFile, false);
+    }));
+    results.append(runBench("yaml_load", totalNodes, yamlBytes, repeats, [&]() {
+        document.loadFromYAML(yamlFile);
+    }));
+
+    results.append(runBench("yaml_save", totalNodes, yamlBytes, repeats, [&]() {
+        document.saveToYAML(yamlFile, data.id);
+    }));
+
+    // Binary format: the document must read back exactly as written (with
+    // every interpolation mode), and a node at a negative time must be rejected
+    const QString binaryFile = tempDir.filePath("bench.mpb");
+    {
+        MotionDocumentData written = data;
+        for (int m = 0; m < written.motors.size(); ++m) {
+            written.motors[m].interpolation = InterpolationMode(m % INTERPOLATION_MODE_COUNT);
+        }
+        MotionDocumentData read;
+        QString error;
+        if (!binaryRoundTrip(binaryFile, written, &read, &error) || !sameDocument(written, read)) {
+            qWarning() << "Binary round trip failed" << error;
+            return 1;
+        }
+        written.motors.first().nodes.first().setX(-1.0);
+        if (binaryRoundTrip(binaryFile, written, &read, &error)) {
+            qWarning() << "Binary reader accepted a node at a negative time";
+            return 1;
+        }
+    }
+    if (!document.saveToBinary(binaryFile, data.id)) return 1;
+    const qint64 binaryBytes = QFileInfo(binaryFile).size();
+    results.append(runBench("binary_save", totalNodes, binaryBytes, repeats, [&]() {
+        document.saveToBinary(binaryFile, data.id);
+    }));
+    results.append(runBench("binary_load", totalNodes, binaryBytes, repeats, [&]() {
+        document.loadFromBinary(binaryFile);
+    }));
+
+    // Sampled export at 1 kHz over the whole profile, into memory
+    {
+        QVector<SampleExportMotor> motors = collectExportMotors(data);
+        SampleExportSettings settings;
+        settings.sampleRateHz = 1000.0;
+        settings.endTimeMs = defaultExportEndTime(motors);
+        qint64 exportBytes = 0;
+        results.append(runBench("sample_export_yaml", qint64(motors.size()) * exportSampleCount(settings), 0, repeats, [&]() {
+            QBuffer buffer;
+            buffer.open(QIODevice::WriteOnly);
+            exportSamples(&buffer, data.id, motors, settings);
+            exportBytes = buffer.size();
+        }));
+        results.last().bytes = exportBytes;
+    }
+
+    // Scene rebuild: loading the document into an attached view, then the
+    // frame that builds the curve items and the handles of the active motor
+    // (flushed directly, as the frame timer never fires without an event loop)
+    {
+        MotionDocument viewDocument; // Outlives the view
+        GraphEditorView view;
+        view.resize(1280, 720);
+        view.setDocument(&viewDocument);
+        results.append(runBench("scene_rebuild", totalNodes, 0, repeats, [&]() {
+            viewDocument.loadData(data);
+            view.flushPendingFrame();
+        }));
+    }
+
+    QJsonObject root;
+    root["benchmark"] = "motion_bench";
+    root["motors"] = motorCount;
+    root["nodes_per_motor"] = nodeCount;
+    root["repeats"] = repeats;
+    root["allocation_counter"] = ALLOCATION_COUNTER;
+    root["qt_version"] = QString(qVersion());
+    root["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    QJsonArray array;
+    for (const BenchResult& result : results) array.append(toJson(result));
+    root["results"] = array;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(jsonOption)) {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            qWarning() << "Cannot write" << parser.value(jsonOption) << file.errorString();
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "binaryformat.h"
+#include <QFile>
+#include <QIODevice>
+#include <QtEndian>
+#include <QtNumeric> // qIsFinite
+#include <climits> // INT_MAX
+#include <cstring> // memcpy, memcmp
+
+static const int HEADER_SIZE = 32;
+static const int TOC_ENTRY_SIZE = 64;
+static const int NODE_SIZE = 2 * sizeof(double);
+// TOC flags: bits 0-7 hold the InterpolationMode, the rest are reserved (0)
+static const quint32 FLAG_INTERPOLATION_MASK = 0xff;
+
+// Node arrays can be copied byte-for-byte when QPointF is two native little-endian doubles
+static const bool NODES_ARE_RAW_LE = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+                                     && sizeof(MotionNode) == NODE_SIZE && sizeof(qreal) == sizeof(double);
+
+static void setError(QString* errorString, const QString& message) {
+    if (errorString) *errorString = message;
+}
+
+static quint64 alignTo8(quint64 value) {
+    return (value + 7) & ~quint64(7);
+}
+
+// --- Little-endian field helpers ---
+static void putU32(char* dst, quint32 value) { qToLittleEndian(value, dst); }
+static void putU64(char* dst, quint64 value) { qToLittleEndian(value, dst); }
+static void putF64(char* dst, double value) {
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(dst, bits);
+}
+static quint32 getU32(const uchar* src) { return qFromLittleEndian<quint32>(src); }
+static quint64 getU64(const uchar* src) { return qFromLittleEndian<quint64>(src); }
+static double getF64(const uchar* src) {
+    quint64 bits = getU64(src);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool writeBinaryDocument(QIODevice* device, const MotionDocumentData& data, QString* errorString) {
+    if (!device) {
+        setError(errorString, "No output device");
+        return false;
+    }
+    const int motorCount = data.motors.size();
+    const QByteArray idBytes = data.id.toUtf8();
+    QVector<QByteArray> names;
+    names.reserve(motorCount);
+    for (const MotorData& motor : data.motors) names.append(motor.name.toUtf8());
+
+    // Layout: header, TOC, strings, then 8-byte aligned node arrays
+    const quint64 tocOffset = HEADER_SIZE;
+    quint64 offset = tocOffset + quint64(motorCount) * TOC_ENTRY_SIZE;
+    const quint64 idOffset = offset;
+    offset += idBytes.size();
+    QVector<quint64> nameOffsets(motorCount);
+    for (int i = 0; i < motorCount; ++i) {
+        nameOffsets[i] = offset;
+        offset += names[i].size();
+    }
+    QVector<quint64> nodeOffsets(motorCount);
+    for (int i = 0; i < motorCount; ++i) {
+        offset = alignTo8(offset);
+        nodeOffsets[i] = offset;
+        offset += quint64(data.motors[i].nodes.size()) * NODE_SIZE;
+    }
+
+    // Header, TOC and strings are small: build them in one buffer
+    QByteArray head(int(alignTo8(nameOffsets.isEmpty() ? idOffset + idBytes.size()
+                                                       : nameOffsets.last() + names.last().size())), '\0');
+    char* p = head.data();
+    std::memcpy(p, MOTION_BINARY_MAGIC, 4);
+    putU32(p + 4, MOTION_BINARY_VERSION);
+    putU32(p + 8, quint32(motorCount));
+    putU32(p + 12, quint32(idBytes.size()));
+    putU64(p + 16, idOffset);
+    putU64(p + 24, tocOffset);
+    for (int i = 0; i < motorCount; ++i) {
+        const MotorData& motor = data.motors[i];
+        char* entry = p + tocOffset + quint64(i) * TOC_ENTRY_SIZE;
+        putU64(entry, nameOffsets[i]);
+        putU32(entry + 8, quint32(names[i].size()));
+        putU32(entry + 12, motor.color);
+        putF64(entry + 16, motor.yMin);
+        putF64(entry + 24, motor.yMax);
+        putF64(entry + 32, motor.maxSlope);
+        putU64(entry + 40, quint64(motor.nodes.size()));
+        putU64(entry + 48, nodeOffsets[i]);
+        putU32(entry + 56, quint32(motor.interpolation) & FLAG_INTERPOLATION_MASK); // flags
+        putU32(entry + 60, 0); // reserved
+    }
+    std::memcpy(p + idOffset, idBytes.constData(), idBytes.size());
+    for (int i = 0; i < motorCount; ++i) {
+        std::memcpy(p + nameOffsets[i], names[i].constData(), names[i].size());
+    }
+    if (device->write(head) != head.size()) {
+        setError(errorString, device->errorString());
+        return false;
+    }
+
+    // Node arrays: written straight from the vectors when the memory layout matches
+    quint64 written = head.size();
+    for (int i = 0; i < motorCount; ++i) {
+        const QVector<MotionNode>& nodes = data.motors[i].nodes;
+        if (written < nodeOffsets[i]) {
+            QByteArray padding(int(nodeOffsets[i] - written), '\0');
+            if (device->write(padding) != padding.size()) {
+                setError(errorString, device->errorString());
+                return false;
+            }
+            written = nodeOffsets[i];
+        }
+        QByteArray converted;
+        const char* bytes;
+        if (NODES_ARE_RAW_LE) {
+            bytes = reinterpret_cast<const char*>(nodes.constData());
+        } else {
+            converted.resize(nodes.size() * NODE_SIZE);
+            for (int n = 0; n < nodes.size(); ++n) {
+                putF64(converted.data() + n * NODE_SIZE, nodes[n].x());
+                putF64(converted.data() + n * NODE_SIZE + 8, nodes[n].y());
+            }
+            bytes = converted.constData();
+        }
+        const qint64 size = qint64(nodes.size()) * NODE_SIZE;
+        if (device->write(bytes, size) != size) {
+            setError(errorString, device->errorString());
+            return false;
+        }
+        written += size;
+    }
+    return true;
+}
+
+bool readBinaryDocument(const QString& filename, MotionDocumentData* data, QString* errorString,
+                        const DocumentReadProgress& progress) {
+    if (!data) return false;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(errorString, file.errorString());
+        return false;
+    }
+    const quint64 fileSize = quint64(file.size());
+    if (fileSize < HEADER_SIZE) {
+        setError(errorString, "File is too small for a binary profile header");
+        return false;
+    }
+    const uchar* base = file.map(0, file.size());
+    if (!base) {
+        setError(errorString, "Failed to map file: " + file.errorString());
+        return false;
+    }
+
+    // True if [offset, offset + size) lies inside the file (overflow-safe)
+    auto inFile = [fileSize](quint64 offset, quint64 size) {
+        return offset <= fileSize && size <= fileSize - offset;
+    };
+
+    if (std::memcmp(base, MOTION_BINARY_MAGIC, 4) != 0) {
+        setError(errorString, "Not a binary motion profile (bad magic)");
+        return false;
+    }
+    const quint32 version = getU32(base + 4);
+    if (version < MOTION_BINARY_MIN_VERSION || version > MOTION_BINARY_VERSION) {
+        setError(errorString, QString("Unsupported binary profile version %1").arg(version));
+        return false;
+    }
+    const quint32 motorCount = getU32(base + 8);
+    const quint32 idLength = getU32(base + 12);
+    const quint64 idOffset = getU64(base + 16);
+    const quint64 tocOffset = getU64(base + 24);
+    if (!inFile(idOffset, idLength) || !inFile(tocOffset, quint64(motorCount) * TOC_ENTRY_SIZE)) {
+        setError(errorString, "Corrupt binary profile header");
+        return false;
+    }
+
+    MotionDocumentData result;
+    result.id = QString::fromUtf8(reinterpret_cast<const char*>(base + idOffset), int(idLength));
+    result.motors.resize(int(motorCount));
+    for (quint32 i = 0; i < motorCount; ++i) {
+        const uchar* entry = base + tocOffset + quint64(i) * TOC_ENTRY_SIZE;
+        const quint64 nameOffset = getU64(entry);
+        const quint32 nameLength = getU32(entry + 8);
+        const quint64 nodeCount = getU64(entry + 40);
+        const quint64 nodeOffset = getU64(entry + 48);
+        if (!inFile(nameOffset, nameLength) || nodeCount > quint64(INT_MAX / NODE_SIZE)
+            || !inFile(nodeOffset, nodeCount * NODE_SIZE)) {
+            setError(errorString, QString("Corrupt table of contents entry for motor %1").arg(i));
+            return false;
+        }
+
+        MotorData& motor = result.motors[int(i)];
+        motor.name = QString::fromUtf8(reinterpret_cast<const char*>(base + nameOffset), int(nameLength));
+        motor.color = getU32(entry + 12);
+        const quint32 mode = version >= 2 ? getU32(entry + 56) & FLAG_INTERPOLATION_MASK : 0;
+        if (mode >= quint32(INTERPOLATION_MODE_COUNT)) {
+            setError(errorString, QString("Unknown interpolation mode %1 for motor %2").arg(mode).arg(i));
+            return false;
+        }
+        motor.interpolation = InterpolationMode(mode);
+        motor.yMin = getF64(entry + 16);
+        motor.yMax = getF64(entry + 24);
+        motor.maxSlope = getF64(entry + 32);
+        if (!qIsFinite(motor.yMin) || !qIsFinite(motor.yMax) || !qIsFinite(motor.maxSlope)) {
+            setError(errorString, QString("Invalid constraints for motor %1").arg(i));
+            return false;
+        }
+        motor.nodes.resize(int(nodeCount));
+        const uchar* src = base + nodeOffset;
+        if (NODES_ARE_RAW_LE) {
+            std::memcpy(static_cast<void*>(motor.nodes.data()), src, size_t(nodeCount) * NODE_SIZE);
+        } else {
+            for (int n = 0; n < int(nodeCount); ++n) {
+                motor.nodes[n] = MotionNode(getF64(src + n * NODE_SIZE), getF64(src + n * NODE_SIZE + 8));
+            }
+        }
+        // Same rule as MotorProfile::isNodeValid, plus finite values
+        for (const MotionNode& node : qAsConst(motor.nodes)) {
+            if (!qIsFinite(node.x()) || !qIsFinite(node.y()) || node.x() < 0.0) {
+                setError(errorString, QString("Invalid node (%1, %2) for motor %3").arg(node.x()).arg(node.y()).arg(i));
+                return false;
+            }
+        }
+        if (progress && !progress(qint64(i) + 1, qint64(motorCount))) {
+            setError(errorString, "Canceled");
+            return false;
+        }
+    }
+    *data = result;
+    return true; // The mapping is released when 'file' closes
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "documentdata.h"
+
+class QIODevice;
+
+/**
+ * Compact binary profile format (*.mpb). All values are little-endian.
+ *
+ *   Header (32 bytes)
+ *     char[4]  magic "MPRF"
+ *     uint32   version
+ *     uint32   motor count
+ *     uint32   id length (UTF-8 bytes)
+ *     uint64   id offset
+ *     uint64   table of contents offset
+ *   Table of contents (64 bytes per motor)
+ *     uint64   name offset
+ *     uint32   name length (UTF-8 bytes)
+ *     uint32   color (ARGB)
+ *     double   y min, y max, max slope
+ *     uint64   node count
+ *     uint64   node offset (8-byte aligned)
+ *     uint32   flags: version 2: bits 0-7 interpolation mode, rest 0;
+ *                     version 1: 0 (every motor is linear)
+ *     uint32   reserved (0)
+ *   String data (id and names)
+ *   Node arrays: node count * (double x, double y)
+ *
+ * Readers map the file and copy the node arrays as-is (no text parsing).
+ * Files with non-finite values or nodes at negative times are rejected.
+ * Versions MOTION_BINARY_MIN_VERSION..MOTION_BINARY_VERSION are read; newer
+ * files are rejected, since their fields may change what the data means.
+ *   1: initial format
+ *   2: interpolation mode in the TOC flags
+ */
+const char MOTION_BINARY_MAGIC[4] = { 'M', 'P', 'R', 'F' };
+const quint32 MOTION_BINARY_VERSION = 2;     // Version written
+const quint32 MOTION_BINARY_MIN_VERSION = 1; // Oldest version read
+const char MOTION_BINARY_SUFFIX[] = "mpb";
+
+// Writes 'data' to an open device; false (with a message) on error
+bool writeBinaryDocument(QIODevice* device, const MotionDocumentData& data, QString* errorString = nullptr);
+
+// Reads a whole binary document through a memory map of 'filename'.
+// 'progress' gets (motors read, motor count); canceling fails the read.
+bool readBinaryDocument(const QString& filename, MotionDocumentData* data, QString* errorString = nullptr,
+                        const DocumentReadProgress& progress = DocumentReadProgress());
@@ -1,29 +1,39 @@
 #include "commands.h"
 #include <QDebug>
 #include <QSet>
+#include <algorithm> // std::remove_if
+
+// Commands refer to nodes by their stable ID and look the index up in O(1)
 
 // --- AddNodeCommand Implementation ---
 AddNodeCommand::AddNodeCommand(MotorProfile* profile, const MotionNode& node, QUndoCommand* parent)
-    : QUndoCommand(parent), m_profile(profile), m_node(node), m_nodeIndex(-1) {
+    : NodeEditCommand(profile, parent), m_node(node) {
     setText("Add Node");
 }
 void AddNodeCommand::redo() {
     if (!m_profile) return;
-    m_nodeIndex = m_profile->internalAddNode(m_node);
-    // m_profile->emitDataChanged(); // Done by internalAddNode
+    int index = m_profile->internalAddNode(m_node, m_nodeId);
+    m_nodeId = m_profile->nodeId(index);
 }
 void AddNodeCommand::undo() {
-    if (!m_profile || m_nodeIndex == -1) return;
-    m_profile->internalRemoveNode(m_nodeIndex);
-    m_nodeIndex = -1;
-    // m_profile->emitDataChanged(); // Done by internalRemoveNode
+    if (!m_profile) return;
+    int index = m_profile->indexOfNode(m_nodeId);
+    if (index == -1) {
+        qWarning() << "AddNodeCommand undo: Node" << m_nodeId << "not found.";
+        return;
+    }
+    m_profile->internalRemoveNode(index);
+}
+QVector<NodeChange> AddNodeCommand::nodeChanges() const {
+    return { NodeChange{ m_nodeId, false, MotionNode(), true, m_node } };
 }
 
 // --- DeleteNodeCommand Implementation ---
 DeleteNodeCommand::DeleteNodeCommand(MotorProfile* profile, int index, QUndoCommand* parent)
-    : QUndoCommand(parent), m_profile(profile), m_nodeIndex(index) {
+    : NodeEditCommand(profile, parent), m_nodeId(0) {
     if (m_profile && index >= 0 && index < m_profile->nodeCount()) {
         m_node = m_profile->nodeAt(index);
+        m_nodeId = m_profile->nodeId(index);
     } else {
         qWarning() << "DeleteNodeCommand: Invalid index" << index;
         m_node = QPointF();
@@ -32,53 +42,211 @@ DeleteNodeCommand::DeleteNodeCommand(MotorProfile* profile, int index, QUndoComm
 }
 void DeleteNodeCommand::redo() {
     if (!m_profile) return;
-    int indexToUse = m_nodeIndex;
-    if (indexToUse < 0 || indexToUse >= m_profile->nodeCount() || m_profile->nodeAt(indexToUse) != m_node) {
-         indexToUse = m_profile->nodes().indexOf(m_node);
-    }
-
-    if (indexToUse != -1) {
-         m_profile->internalRemoveNode(indexToUse);
-         m_nodeIndex = indexToUse;
+    int index = m_profile->indexOfNode(m_nodeId);
+    if (index != -1) {
+         m_profile->internalRemoveNode(index);
     } else {
-         qWarning() << "DeleteNodeCommand redo: Node not found or index invalid.";
+         qWarning() << "DeleteNodeCommand redo: Node" << m_nodeId << "not found.";
     }
 }
 void DeleteNodeCommand::undo() {
-    if (!m_profile || m_node.isNull()) return;
-    m_nodeIndex = m_profile->internalAddNode(m_node);
+    if (!m_profile || m_nodeId == 0) return;
+    m_profile->internalAddNode(m_node, m_nodeId);
+}
+QVector<NodeChange> DeleteNodeCommand::nodeChanges() const {
+    return { NodeChange{ m_nodeId, true, m_node, false, MotionNode() } };
 }
 
 // --- MoveNodeCommand Implementation ---
 MoveNodeCommand::MoveNodeCommand(MotorProfile* profile, int index, const QPointF& oldPos, const QPointF& newPos, QUndoCommand* parent)
-    : QUndoCommand(parent), m_profile(profile), m_nodeIndex(index), m_oldPos(oldPos), m_newPos(newPos) {
+    : NodeEditCommand(profile, parent), m_nodeId(profile ? profile->nodeId(index) : 0), m_oldPos(oldPos), m_newPos(newPos) {
     setText("Move Node");
 }
 void MoveNodeCommand::redo() {
     if (!m_profile) return;
-    if (m_nodeIndex >= 0 && m_nodeIndex < m_profile->nodeCount()) {
-        m_profile->internalMoveNode(m_nodeIndex, m_newPos);
-        m_profile->sortNodes();
-        m_profile->emitDataChanged();
-    } else { qWarning() << "MoveNodeCommand redo: Invalid index" << m_nodeIndex; }
+    int index = m_profile->indexOfNode(m_nodeId);
+    if (index != -1) {
+        m_profile->internalMoveNode(index, m_newPos);
+    } else { qWarning() << "MoveNodeCommand redo: Node" << m_nodeId << "not found."; }
 }
 void MoveNodeCommand::undo() {
     if (!m_profile) return;
-    if (m_nodeIndex >= 0 && m_nodeIndex < m_profile->nodeCount()) {
-        m_profile->internalMoveNode(m_nodeIndex, m_oldPos);
-        m_profile->sortNodes();
-        m_profile->emitDataChanged();
-    } else { qWarning() << "MoveNodeCommand undo: Invalid index" << m_nodeIndex; }
+    int index = m_profile->indexOfNode(m_nodeId);
+    if (index != -1) {
+        m_profile->internalMoveNode(index, m_oldPos);
+    } else { qWarning() << "MoveNodeCommand undo: Node" << m_nodeId << "not found."; }
 }
 bool MoveNodeCommand::mergeWith(const QUndoCommand* command) {
     const MoveNodeCommand* moveCommand = dynamic_cast<const MoveNodeCommand*>(command);
-    if (!moveCommand || moveCommand->id() != id() || !moveCommand->m_profile || moveCommand->m_profile != m_profile || moveCommand->m_nodeIndex != m_nodeIndex) {
+    if (!moveCommand || moveCommand->id() != id() || !moveCommand->m_profile || moveCommand->m_profile != m_profile || moveCommand->m_nodeId != m_nodeId) {
         return false;
     }
     m_newPos = moveCommand->m_newPos;
     setText("Move Node to (" + QString::number(m_newPos.x(),'f',1) + ", " + QString::number(m_newPos.y(),'f',1) + ")");
     return true;
 }
+QVector<NodeChange> MoveNodeCommand::nodeChanges() const {
+    return { NodeChange{ m_nodeId, true, m_oldPos, true, m_newPos } };
+}
+
+// --- Node change replay ---
+// Up to this many changes are replayed with per-node signals, so the views
+// update incrementally; larger batches notify once with dataChanged
+static const int MAX_SIGNALED_CHANGES = 32;
+
+// Puts every changed node into its after (or before) state
+static void applyNodeChanges(MotorProfile* profile, const QVector<NodeChange>& changes, bool toAfter) {
+    bool batched = changes.size() > MAX_SIGNALED_CHANGES;
+    if (batched) profile->beginBatch();
+    // Removals first, then moves, then re-adds with their original IDs
+    for (const NodeChange& change : changes) {
+        bool exists = toAfter ? change.existsAfter : change.existedBefore;
+        int index = profile->indexOfNode(change.id);
+        if (!exists && index != -1) profile->internalRemoveNode(index);
+    }
+    for (const NodeChange& change : changes) {
+        if (!change.existedBefore || !change.existsAfter) continue;
+        int index = profile->indexOfNode(change.id);
+        if (index != -1) {
+            profile->internalMoveNode(index, toAfter ? change.after : change.before);
+        } else { qWarning() << "applyNodeChanges: Node" << change.id << "not found."; }
+    }
+    for (const NodeChange& change : changes) {
+        bool exists = toAfter ? change.existsAfter : change.existedBefore;
+        if (exists && profile->indexOfNode(change.id) == -1) {
+            profile->internalAddNode(toAfter ? change.after : change.before, change.id);
+        }
+    }
+    if (batched) profile->commitBatch();
+}
+
+// --- BatchEditCommand Implementation ---
+BatchEditCommand::BatchEditCommand(MotorProfile* profile, const QVector<NodeChange>& changes, const QString& text, QUndoCommand* parent)
+    : NodeEditCommand(profile, parent), m_changes(changes) {
+    setText(text);
+}
+void BatchEditCommand::redo() {
+    if (!m_profile) return;
+    if (m_applied) { // First push: the batch is already in the profile
+        m_applied = false;
+        return;
+    }
+    applyNodeChanges(m_profile, m_changes, true);
+}
+void BatchEditCommand::undo() {
+    if (!m_profile) return;
+    applyNodeChanges(m_profile, m_changes, false);
+}
+qint64 BatchEditCommand::memoryCost() const {
+    return baseMemoryCost(sizeof(*this)) + qint64(m_changes.size()) * qint64(sizeof(NodeChange));
+}
+
+// --- SetInterpolationModeCommand Implementation ---
+SetInterpolationModeCommand::SetInterpolationModeCommand(MotorProfile* profile, InterpolationMode mode, QUndoCommand* parent)
+    : UndoCommand(parent), m_profile(profile),
+      m_oldMode(profile ? profile->interpolationMode() : mode), m_newMode(mode) {
+    setText("Set Interpolation to " + interpolationModeLabel(mode));
+}
+void SetInterpolationModeCommand::redo() {
+    if (m_profile) m_profile->setInterpolationMode(m_newMode);
+}
+void SetInterpolationModeCommand::undo() {
+    if (m_profile) m_profile->setInterpolationMode(m_oldMode);
+}
+
+// --- CheckpointCommand Implementation ---
+// Node positions do not depend on the mode, so the two are replayed independently
+CheckpointCommand::CheckpointCommand(const QVector<ProfileChanges>& profiles, int commandCount, QUndoCommand* parent)
+    : UndoCommand(parent), m_profiles(profiles), m_commandCount(commandCount) {
+    setText(QString("Checkpoint (%1 Edits)").arg(commandCount));
+}
+void CheckpointCommand::redo() {
+    for (const ProfileChanges& entry : qAsConst(m_profiles)) {
+        if (!entry.profile) continue;
+        applyNodeChanges(entry.profile, entry.changes, true);
+        if (entry.modeChanged) entry.profile->setInterpolationMode(entry.modeAfter);
+    }
+}
+void CheckpointCommand::undo() {
+    for (const ProfileChanges& entry : qAsConst(m_profiles)) {
+        if (!entry.profile) continue;
+        applyNodeChanges(entry.profile, entry.changes, false);
+        if (entry.modeChanged) entry.profile->setInterpolationMode(entry.modeBefore);
+    }
+}
+qint64 CheckpointCommand::memoryCost() const {
+    qint64 cost = baseMemoryCost(sizeof(*this)) + qint64(m_profiles.size()) * qint64(sizeof(ProfileChanges));
+    for (const ProfileChanges& entry : m_profiles) cost += qint64(entry.changes.size()) * qint64(sizeof(NodeChange));
+    return cost;
+}
+
+// Chains each profile's changes by node ID: a node keeps its first 'before'
+// and its last 'after' (the mode likewise), and changes that cancel out are
+// dropped at the end
+QUndoCommand* compactEditCommands(const QList<QUndoCommand*>& commands) {
+    QVector<ProfileChanges> profiles;
+    QHash<MotorProfile*, int> profileIndex;
+    QVector<QHash<quint32, int>> changeIndex; // Per profile: node ID -> index into its changes
+    int commandCount = 0;
+    auto entryFor = [&](MotorProfile* profile) -> int {
+        int p = profileIndex.value(profile, -1);
+        if (p == -1) {
+            p = profiles.size();
+            profileIndex.insert(profile, p);
+            ProfileChanges entry;
+            entry.profile = profile;
+            profiles.append(entry);
+            changeIndex.append(QHash<quint32, int>());
+        }
+        return p;
+    };
+    auto accumulateMode = [&](MotorProfile* profile, InterpolationMode before, InterpolationMode after) {
+        ProfileChanges& entry = profiles[entryFor(profile)];
+        if (!entry.modeChanged) {
+            entry.modeChanged = true;
+            entry.modeBefore = before;
+        }
+        entry.modeAfter = after;
+    };
+    auto accumulate = [&](MotorProfile* profile, const QVector<NodeChange>& changes) {
+        int p = entryFor(profile);
+        QVector<NodeChange>& net = profiles[p].changes;
+        for (const NodeChange& change : changes) {
+            int known = changeIndex[p].value(change.id, -1);
+            if (known == -1) {
+                changeIndex[p].insert(change.id, net.size());
+                net.append(change);
+            } else {
+                net[known].existsAfter = change.existsAfter;
+                net[known].after = change.after;
+            }
+        }
+    };
+    for (const QUndoCommand* command : commands) {
+        if (auto checkpoint = dynamic_cast<const CheckpointCommand*>(command)) {
+            for (const ProfileChanges& entry : checkpoint->profiles()) {
+                accumulate(entry.profile, entry.changes);
+                if (entry.modeChanged) accumulateMode(entry.profile, entry.modeBefore, entry.modeAfter);
+            }
+            commandCount += checkpoint->commandCount();
+        } else if (auto edit = dynamic_cast<const NodeEditCommand*>(command)) {
+            accumulate(edit->profile(), edit->nodeChanges());
+            ++commandCount;
+        } else if (auto modeEdit = dynamic_cast<const SetInterpolationModeCommand*>(command)) {
+            accumulateMode(modeEdit->profile(), modeEdit->oldMode(), modeEdit->newMode());
+            ++commandCount;
+        } else {
+            return nullptr;
+        }
+    }
+    for (ProfileChanges& entry : profiles) {
+        entry.changes.erase(std::remove_if(entry.changes.begin(), entry.changes.end(),
+                                           [](const NodeChange& change) { return change.isNoOp(); }),
+                            entry.changes.end());
+        if (entry.modeBefore == entry.modeAfter) entry.modeChanged = false;
+    }
+    return new CheckpointCommand(profiles, commandCount);
+}
 
 // <<< MoveNodesCommand 구현부 삭제 >>>
 
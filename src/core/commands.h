@@ -1,56 +1,147 @@
 #pragma once
 
-#include <QUndoCommand>
+#include "undohistory.h" // UndoCommand
 #include <QPointF>
 #include <QList>
 #include <QSet>
 #include "motionmodels.h" // For MotionNode, MotorProfile
+#include "interpolation.h" // interpolationModeLabel
+
+/**
+ * @brief Base of the commands that add, delete or move nodes of one profile.
+ * nodeChanges() describes the command as node changes by ID ('before' is the
+ * undone state, 'after' the done state), so compactEditCommands() can merge
+ * old commands into a checkpoint.
+ */
+class NodeEditCommand : public UndoCommand {
+public:
+    explicit NodeEditCommand(MotorProfile* profile, QUndoCommand* parent = nullptr)
+        : UndoCommand(parent), m_profile(profile) {}
+    MotorProfile* profile() const { return m_profile; }
+    virtual QVector<NodeChange> nodeChanges() const = 0;
+protected:
+    MotorProfile* m_profile;
+};
 
 /**
  * @brief Undo/Redo command for adding a new node.
  */
-class AddNodeCommand : public QUndoCommand {
+class AddNodeCommand : public NodeEditCommand {
 public:
     AddNodeCommand(MotorProfile* profile, const MotionNode& node, QUndoCommand* parent = nullptr);
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override { return baseMemoryCost(sizeof(*this)); }
+    QVector<NodeChange> nodeChanges() const override;
 private:
-    MotorProfile* m_profile;
     MotionNode m_node;
-    int m_nodeIndex = -1;
+    quint32 m_nodeId = 0; // Assigned on the first redo, reused afterwards
 };
 
 /**
  * @brief Undo/Redo command for deleting an existing node.
  */
-class DeleteNodeCommand : public QUndoCommand {
+class DeleteNodeCommand : public NodeEditCommand {
 public:
     DeleteNodeCommand(MotorProfile* profile, int index, QUndoCommand* parent = nullptr);
     void undo() override;
     void redo() override;
+    qint64 memoryCost() const override { return baseMemoryCost(sizeof(*this)); }
+    QVector<NodeChange> nodeChanges() const override;
 private:
-    MotorProfile* m_profile;
     MotionNode m_node;
-    int m_nodeIndex;
+    quint32 m_nodeId;
 };
 
 /**
  * @brief Undo/Redo command for moving a SINGLE node (e.g., from Apply Coordinates).
  */
-class MoveNodeCommand : public QUndoCommand {
+class MoveNodeCommand : public NodeEditCommand {
 public:
     MoveNodeCommand(MotorProfile* profile, int index, const QPointF& oldPos, const QPointF& newPos, QUndoCommand* parent = nullptr);
     void undo() override;
     void redo() override;
     bool mergeWith(const QUndoCommand* command) override;
     int id() const override { return 1234; }
+    qint64 memoryCost() const override { return baseMemoryCost(sizeof(*this)); }
+    QVector<NodeChange> nodeChanges() const override;
 
 private:
-    MotorProfile* m_profile;
-    int m_nodeIndex;
+    quint32 m_nodeId; // Stable across the re-sorts caused by the move
     QPointF m_oldPos;
     QPointF m_newPos;
 };
 
+/**
+ * @brief Undo/Redo command for a batch of node edits on one profile.
+ * Created right after MotorProfile::commitBatch(), with the changes it
+ * returned; the edits are already applied, so the first redo() does nothing.
+ * Only the changed nodes are stored and replayed by ID, so undo and redo
+ * cost O(changed nodes) rather than O(profile size).
+ */
+class BatchEditCommand : public NodeEditCommand {
+public:
+    BatchEditCommand(MotorProfile* profile, const QVector<NodeChange>& changes, const QString& text, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+    qint64 memoryCost() const override;
+    QVector<NodeChange> nodeChanges() const override { return m_changes; }
+private:
+    QVector<NodeChange> m_changes;
+    bool m_applied = true; // Edits were made before the command was pushed
+};
+
+/**
+ * @brief Undo/Redo command for changing a profile's interpolation mode.
+ * The mode reshapes the whole curve and the exported samples, so it is an
+ * edit like any node change.
+ */
+class SetInterpolationModeCommand : public UndoCommand {
+public:
+    SetInterpolationModeCommand(MotorProfile* profile, InterpolationMode mode, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+    qint64 memoryCost() const override { return baseMemoryCost(sizeof(*this)); }
+    MotorProfile* profile() const { return m_profile; }
+    InterpolationMode oldMode() const { return m_oldMode; }
+    InterpolationMode newMode() const { return m_newMode; }
+private:
+    MotorProfile* m_profile;
+    InterpolationMode m_oldMode;
+    InterpolationMode m_newMode;
+};
+
+// Net changes of one profile: its nodes and, if it changed, its mode
+struct ProfileChanges {
+    MotorProfile* profile = nullptr;
+    QVector<NodeChange> changes;
+    bool modeChanged = false;
+    InterpolationMode modeBefore = InterpolationMode::Linear;
+    InterpolationMode modeAfter = InterpolationMode::Linear;
+};
+
+/**
+ * @brief The oldest part of a compacted history as one undo step.
+ * Holds the net changes per profile of the commands it replaced, so its
+ * cost is bounded by the nodes they touched, not by how many edits there
+ * were. Built in the done state by compactEditCommands().
+ */
+class CheckpointCommand : public UndoCommand {
+public:
+    CheckpointCommand(const QVector<ProfileChanges>& profiles, int commandCount, QUndoCommand* parent = nullptr);
+    void undo() override;
+    void redo() override;
+    qint64 memoryCost() const override;
+    const QVector<ProfileChanges>& profiles() const { return m_profiles; }
+    int commandCount() const { return m_commandCount; }
+private:
+    QVector<ProfileChanges> m_profiles;
+    int m_commandCount; // Edits merged into this checkpoint
+};
+
+// UndoHistory compactor: merges done node and mode commands (oldest first)
+// into one CheckpointCommand; nullptr if any of them is of another kind
+QUndoCommand* compactEditCommands(const QList<QUndoCommand*>& commands);
+
 // <<< MoveNodesCommand 선언부 삭제 >>>
 
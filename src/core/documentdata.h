@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QVector>
+#include <QPointF>
+#include <QString>
+#include <QtGlobal> // qAbs
+#include <algorithm> // std::sort
+#include <functional>
+
+using MotionNode = QPointF; // Alias for node data type
+
+// Node order: by X (time), ties by Y. Every profile keeps its nodes in this order.
+inline bool motionNodeLess(const MotionNode& a, const MotionNode& b) {
+    if (qAbs(a.x() - b.x()) < 1e-9) return a.y() < b.y();
+    return a.x() < b.x();
+}
+
+inline void sortMotionNodes(QVector<MotionNode>& nodes) {
+    std::sort(nodes.begin(), nodes.end(), motionNodeLess);
+}
+
+// Progress callback for the file readers: (work done, total work); return
+// false to cancel. Called on the reading thread.
+using DocumentReadProgress = std::function<bool(qint64, qint64)>;
+
+// How a profile is interpolated between its nodes (see interpolation.h).
+// The values are stored in files; only append new modes.
+enum class InterpolationMode : quint8 {
+    Linear = 0,   // Straight segments
+    NaturalCubic, // C2 cubic spline, zero curvature at the ends
+    ClampedCubic, // C2 cubic spline, zero velocity at the ends
+    Pchip,        // Monotone piecewise cubic Hermite (no overshoot)
+    SCurve        // Rest-to-rest quintic per segment (zero velocity and acceleration at every node)
+};
+const int INTERPOLATION_MODE_COUNT = 5;
+
+/**
+ * @brief Plain (non-QObject) copy of one motor's data.
+ * Used by the file formats to read and write documents without touching the
+ * live MotorProfile objects.
+ */
+struct MotorData {
+    QString name;
+    quint32 color = 0xff808080; // ARGB (QColor::rgba())
+    double yMin = -100.0;
+    double yMax = 100.0;
+    double maxSlope = 1000.0;
+    InterpolationMode interpolation = InterpolationMode::Linear;
+    QVector<MotionNode> nodes; // Sorted by X
+};
+
+/**
+ * @brief Plain copy of a whole document (file id and motors in order).
+ */
+struct MotionDocumentData {
+    QString id;
+    QVector<MotorData> motors;
+};
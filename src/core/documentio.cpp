@@ -0,0 +1,50 @@
+#include "documentio.h"
+#include "binaryformat.h"
+#include "yamlparser.h"
+#include "perftrace.h"
+#include <QDebug>
+#include <QFileInfo>
+
+bool isBinaryDocumentFile(const QString& fileName) {
+    return QFileInfo(fileName).suffix().compare(MOTION_BINARY_SUFFIX, Qt::CaseInsensitive) == 0;
+}
+
+DocumentReadResult readDocumentFile(const QString& filename, bool binary,
+                                    const DocumentReadProgress& progress) {
+    PERF_SCOPE("readDocumentFile");
+    DocumentReadResult result;
+    // Remembers a cancel, so it is not reported as a read error
+    bool canceled = false;
+    DocumentReadProgress onProgress;
+    if (progress) {
+        onProgress = [&](qint64 done, qint64 total) {
+            canceled = !progress(done, total);
+            return !canceled;
+        };
+    }
+
+    if (binary) {
+        if (!readBinaryDocument(filename, &result.data, &result.errorString, onProgress) && !canceled) {
+            qWarning() << "Failed to read binary profile:" << filename << result.errorString;
+            result.status = DocumentReadStatus::Failed;
+        }
+    } else {
+        QVector<YamlParseIssue> issues;
+        if (!readMotionYaml(filename, &result.data, &issues, &result.errorString, onProgress)
+            && !result.errorString.isEmpty()) {
+            qWarning() << "Failed to open file for reading:" << filename << result.errorString;
+            result.status = DocumentReadStatus::Failed;
+            return result;
+        }
+        if (!canceled) {
+            for (const YamlParseIssue& issue : issues) {
+                result.warnings.append(QString("%1:%2: %3").arg(issue.line).arg(issue.column).arg(issue.message));
+            }
+        }
+    }
+    if (canceled) {
+        result.status = DocumentReadStatus::Canceled;
+        result.data = MotionDocumentData(); // Incomplete
+    }
+    return result;
+}
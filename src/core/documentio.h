@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include "documentdata.h"
+
+enum class DocumentReadStatus {
+    Ok,
+    Canceled,
+    Failed
+};
+
+/**
+ * @brief A document file read into detached data, ready for MotionDocument::loadData.
+ */
+struct DocumentReadResult {
+    DocumentReadStatus status = DocumentReadStatus::Ok;
+    QString errorString;
+    QStringList warnings; // YAML parse issues ("line:column: message"); the lines were skipped
+    MotionDocumentData data;
+};
+
+// True if 'fileName' uses the binary format (by suffix)
+bool isBinaryDocumentFile(const QString& fileName);
+
+/**
+ * @brief Reads a YAML or binary document file into plain data.
+ * Thread-safe and independent of any MotionDocument, so it can run on a
+ * worker thread. YAML parse issues are returned in 'warnings' of an Ok
+ * result; motor colors are left at their defaults. A canceled read returns
+ * empty data.
+ */
+DocumentReadResult readDocumentFile(const QString& filename, bool binary,
+                                    const DocumentReadProgress& progress = DocumentReadProgress());
@@ -1,22 +1,26 @@
 #include "grapheditorview.h"
 #include "motionmodels.h"
 #include "graphnodeitem.h"
+#include "profilecurveitem.h"
 #include "commands.h"
-#include <QUndoStack>
+#include "undohistory.h"
+#include "perftrace.h"
 #include <QKeyEvent>
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
 #include <QMenu>
 #include <QScrollBar>
-#include <QGraphicsLineItem>
 #include <QPen>
 #include <QBrush>
 #include <QDebug>
 #include <QTransform>
 #include <QPainter>
+#include <QPixmap>
 #include <QtMath>
 #include <QApplication> // For RubberBandDrag cursor
+#include <QCursor>
+#include <algorithm> // std::lower_bound
 
 /**
  * @brief Helper function to calculate the motor-specific visual Y scale factor.
@@ -39,13 +43,17 @@ GraphEditorView::GraphEditorView(QWidget* parent)
 {
     setScene(m_scene);
     setRenderHint(QPainter::Antialiasing);
-    setDragMode(QGraphicsView::NoDrag); // <<< RubberBandDrag -> NoDrag
+    setDragMode(QGraphicsView::RubberBandDrag); // Left-drag on empty space selects nodes
     setTransformationAnchor(AnchorUnderMouse);
     setAlignment(Qt::AlignLeft | Qt::AlignTop);
     m_scene->setSceneRect(-1000000, -1000000, 2000000, 2000000);
     setFocusPolicy(Qt::StrongFocus);
     scale(1, -1);
     connect(m_scene, &QGraphicsScene::selectionChanged, this, &GraphEditorView::onSceneSelectionChanged);
+
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(FRAME_INTERVAL_MS);
+    connect(&m_frameTimer, &QTimer::timeout, this, &GraphEditorView::processFrame);
 }
 
 void GraphEditorView::setDocument(MotionDocument* doc) {
@@ -58,13 +66,12 @@ void GraphEditorView::setDocument(MotionDocument* doc) {
     m_document = doc;
     clearAllProfileItems();
     if (!m_document) {
-        update();
+        scheduleRepaint();
         return;
     }
     connect(m_document, &MotionDocument::documentCleared, this, &GraphEditorView::onDocumentCleared, Qt::UniqueConnection);
     connect(m_document, &MotionDocument::motorAdded, this, &GraphEditorView::onMotorAdded, Qt::UniqueConnection);
     connect(m_document, &MotionDocument::activeMotorChanged, this, &GraphEditorView::onActiveMotorChanged, Qt::UniqueConnection);
-    connect(m_document, &MotionDocument::activeMotorChanged, this, QOverload<>::of(&GraphEditorView::update), Qt::UniqueConnection);
     for(MotorProfile* profile : m_document->motorProfiles()) {
         if(profile) onMotorAdded(profile);
     }
@@ -75,7 +82,7 @@ void GraphEditorView::setDocument(MotionDocument* doc) {
 void GraphEditorView::wheelEvent(QWheelEvent* event) {
     double scaleFactor = (event->angleDelta().y() > 0) ? 1.15 : (1.0 / 1.15);
     scale(scaleFactor, 1.0);
-    update();
+    scheduleHandleUpdate();
 }
 
 void GraphEditorView::mousePressEvent(QMouseEvent* event) {
@@ -87,8 +94,7 @@ void GraphEditorView::mousePressEvent(QMouseEvent* event) {
         return;
     }
     
-    // <<< 다중 이동 로직 삭제, 기본 동작(아이템 선택)으로 되돌림 >>>
-    QGraphicsView::mousePressEvent(event);
+    QGraphicsView::mousePressEvent(event); // Selection, rubber band and node drags
 }
 
 void GraphEditorView::mouseReleaseEvent(QMouseEvent* event) {
@@ -99,8 +105,6 @@ void GraphEditorView::mouseReleaseEvent(QMouseEvent* event) {
         return;
     }
 
-    // <<< 다중 이동 Undo 로직 삭제 >>>
-    
     QGraphicsView::mouseReleaseEvent(event);
 }
 
@@ -112,6 +116,7 @@ void GraphEditorView::mouseMoveEvent(QMouseEvent* event) {
         event->accept();
         return;
     }
+    if (m_handlesLimited) scheduleHandleUpdate(); // The shown handles follow the cursor
     QGraphicsView::mouseMoveEvent(event);
 }
 
@@ -143,27 +148,90 @@ void GraphEditorView::contextMenuEvent(QContextMenuEvent* event) {
 void GraphEditorView::keyPressEvent(QKeyEvent* event) {
     if (event->key() == Qt::Key_Delete) {
         if (!m_document || !m_document->activeProfile() || !m_undoStack) return;
-        
-        // <<< 다중 삭제 로직 삭제 -> 단일 삭제로 변경 >>>
-        auto selectedItems = m_scene->selectedItems();
-        if (selectedItems.size() != 1) return; // 오직 하나만 선택됐을 때만 삭제
-
-        if (auto nodeItem = qgraphicsitem_cast<GraphNodeItem*>(selectedItems.first())) {
-            if(nodeItem->profile() == m_document->activeProfile()) {
-                // 단일 삭제 Command 푸시
-                m_undoStack->push(new DeleteNodeCommand(nodeItem->profile(), nodeItem->index()));
-                event->accept();
+        MotorProfile* profile = m_document->activeProfile();
+
+        QVector<quint32> ids;
+        for (QGraphicsItem* item : m_scene->selectedItems()) {
+            if (auto nodeItem = qgraphicsitem_cast<GraphNodeItem*>(item)) {
+                if (nodeItem->profile() == profile) ids.append(nodeItem->nodeId());
+            }
+        }
+        if (ids.isEmpty()) return;
+
+        if (ids.size() == 1) {
+            m_undoStack->push(new DeleteNodeCommand(profile, profile->indexOfNode(ids.first())));
+        } else {
+            // All selected nodes in one model change and one undo step
+            profile->beginBatch();
+            for (quint32 id : ids) {
+                int index = profile->indexOfNode(id);
+                if (index >= 0) profile->internalRemoveNode(index);
             }
+            QVector<NodeChange> changes = profile->commitBatch();
+            m_undoStack->push(new BatchEditCommand(profile, changes, QString("Delete %1 Nodes").arg(ids.size())));
         }
+        event->accept();
     } else {
         QGraphicsView::keyPressEvent(event);
     }
 }
 
-// Draw grid, axes, labels, and limit lines
+// The grid layer is rendered once into m_gridCache, GRID_CACHE_MARGIN pixels
+// larger than the viewport on every side, and blitted on every repaint until
+// the zoom, viewport, grid settings or the active motor's limits change.
+// Scrolling only moves the blit offset, until the viewport leaves the cache.
 void GraphEditorView::drawBackground(QPainter* painter, const QRectF& rect) {
+    PERF_SCOPE("GraphEditorView::drawBackground");
     QGraphicsView::drawBackground(painter, rect);
 
+    MotorProfile* activeProfile = m_document ? m_document->activeProfile() : nullptr;
+    const QTransform viewTransform = viewportTransform();
+    const QPoint translation(qFloor(viewTransform.dx()), qFloor(viewTransform.dy()));
+    GridCacheKey key;
+    key.transform = QTransform(viewTransform.m11(), viewTransform.m12(),
+                               viewTransform.m21(), viewTransform.m22(),
+                               viewTransform.dx() - translation.x(), viewTransform.dy() - translation.y());
+    key.viewportSize = viewport()->size();
+    key.devicePixelRatio = viewport()->devicePixelRatioF();
+    key.gridSizeX = m_gridSizeX;
+    key.gridLargeSizeX = m_gridLargeSizeX;
+    key.numYDivisions = m_numYDivisions;
+    key.referenceYValue = m_referenceYValue;
+    key.hasActiveProfile = activeProfile != nullptr;
+    if (activeProfile) {
+        key.yMin = activeProfile->yMin();
+        key.yMax = activeProfile->yMax();
+        key.color = activeProfile->color().rgba();
+    }
+
+    // Viewport position of the cache's top-left corner
+    const QSize cacheSize = key.viewportSize + QSize(2 * GRID_CACHE_MARGIN, 2 * GRID_CACHE_MARGIN);
+    QPoint origin = translation - m_gridCacheTranslation - QPoint(GRID_CACHE_MARGIN, GRID_CACHE_MARGIN);
+    const bool covered = origin.x() <= 0 && origin.y() <= 0
+        && origin.x() + cacheSize.width() >= key.viewportSize.width()
+        && origin.y() + cacheSize.height() >= key.viewportSize.height();
+    if (m_gridCache.isNull() || !(key == m_gridCacheKey) || !covered) {
+        m_gridCacheKey = key;
+        m_gridCacheTranslation = translation;
+        origin = QPoint(-GRID_CACHE_MARGIN, -GRID_CACHE_MARGIN);
+        m_gridCache = QPixmap(cacheSize * key.devicePixelRatio);
+        m_gridCache.setDevicePixelRatio(key.devicePixelRatio);
+        m_gridCache.fill(Qt::transparent);
+        QPainter cachePainter(&m_gridCache);
+        cachePainter.setRenderHints(renderHints());
+        cachePainter.setTransform(viewTransform * QTransform::fromTranslate(GRID_CACHE_MARGIN, GRID_CACHE_MARGIN));
+        const QRect cachedArea(origin, cacheSize);
+        paintGrid(&cachePainter, mapToScene(cachedArea).boundingRect());
+    }
+
+    painter->save();
+    painter->resetTransform(); // Viewport coordinates
+    painter->drawPixmap(origin, m_gridCache);
+    painter->restore();
+}
+
+// Draw grid, axes, labels, and limit lines for the scene area 'rect'
+void GraphEditorView::paintGrid(QPainter* painter, const QRectF& rect) {
     QPen gridPen(QColor(220, 220, 220), 0);
     gridPen.setCosmetic(true);
     QPen axisPen(QColor(150, 150, 150), 2);
@@ -283,23 +351,30 @@ void GraphEditorView::drawBackground(QPainter* painter, const QRectF& rect) {
 // --- Slot Implementations ---
 void GraphEditorView::onDocumentCleared() {
     clearAllProfileItems();
-    update();
+    scheduleRepaint();
 }
 
 void GraphEditorView::clearAllProfileItems() {
-    for(const auto& items : m_profileItems) {
-        qDeleteAll(items);
-    }
-    m_profileItems.clear();
+    m_dirtyProfiles.clear(); // May point at profiles being deleted
+    releaseAllNodeHandles();
+    qDeleteAll(m_curveItems);
+    m_curveItems.clear();
+}
+
+bool GraphEditorView::isActiveProfile(MotorProfile* profile) const {
+    return profile == (m_document ? m_document->activeProfile() : nullptr);
 }
 
 void GraphEditorView::onMotorAdded(MotorProfile* profile) {
-    if (!profile || m_profileItems.contains(profile)) return;
-    m_profileItems.insert(profile, QList<QGraphicsItem*>());
+    if (!profile || m_curveItems.contains(profile)) return;
     rebuildProfileItems(profile);
-    updateProfileVisibility(profile, (profile == (m_document ? m_document->activeProfile() : nullptr) ));
+    updateProfileVisibility(profile, isActiveProfile(profile));
     connect(profile, &MotorProfile::dataChanged, this, &GraphEditorView::onProfileDataChanged, Qt::UniqueConnection);
+    connect(profile, &MotorProfile::nodeInserted, this, &GraphEditorView::onProfileNodeInserted, Qt::UniqueConnection);
+    connect(profile, &MotorProfile::nodeRemoved, this, &GraphEditorView::onProfileNodeRemoved, Qt::UniqueConnection);
+    connect(profile, &MotorProfile::nodeMoved, this, &GraphEditorView::onProfileNodeMoved, Qt::UniqueConnection);
     connect(profile, &MotorProfile::constraintsChanged, this, &GraphEditorView::onProfileConstraintsChanged, Qt::UniqueConnection);
+    connect(profile, &MotorProfile::interpolationChanged, this, &GraphEditorView::onProfileInterpolationChanged, Qt::UniqueConnection);
 }
 
 void GraphEditorView::onActiveMotorChanged(MotorProfile* active, MotorProfile* previous) {
@@ -311,155 +386,417 @@ void GraphEditorView::onActiveMotorChanged(MotorProfile* active, MotorProfile* p
             }
         }
     }
-    update();
+    releaseAllNodeHandles(); // Inactive motors only draw their curve
+    scheduleHandleUpdate();
+    scheduleRepaint(); // Limit lines follow the active motor
 }
 
+// Bulk change (load, clamp to limits): redraw the curve and re-bind the handles
+// on the next frame, however many times it is emitted until then
 void GraphEditorView::onProfileDataChanged() {
     MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
     if (!profile) return;
-    
-    GraphNodeItem* nodeToReselect = nullptr;
-    QMap<GraphNodeItem*, QPointF> oldPositions;
-    if(m_scene->selectedItems().count() == 1) {
-        if (auto node = qgraphicsitem_cast<GraphNodeItem*>(m_scene->selectedItems().first())) {
-            if (node->profile() == profile) {
-                 oldPositions[node] = node->pos();
-            }
+    scheduleProfileUpdate(profile, ItemsDirty | SelectionDirty);
+}
+
+void GraphEditorView::applyProfileDataChange(MotorProfile* profile) {
+    // Handle indices are stale after a bulk change; the selection is kept by node ID
+    QVector<quint32> selectedIds;
+    for (QGraphicsItem* item : m_scene->selectedItems()) {
+        if (auto node = qgraphicsitem_cast<GraphNodeItem*>(item)) {
+            if (node->profile() == profile) selectedIds.append(node->nodeId());
         }
     }
 
+    m_restoringSelection = true;
+    if (isActiveProfile(profile)) releaseAllNodeHandles();
     rebuildProfileItems(profile);
-    updateProfileVisibility(profile, (profile == (m_document ? m_document->activeProfile() : nullptr) ));
-
-    if(oldPositions.count() == 1) {
-        GraphNodeItem* oldNode = oldPositions.firstKey();
-        QPointF oldPos = oldPositions.first();
-        qreal minDist = 1e-2;
-        if (m_profileItems.contains(profile)){
-            for (auto item : m_profileItems.value(profile)) {
-                if (auto node = qgraphicsitem_cast<GraphNodeItem*>(item)) {
-                     if(node->index() == oldNode->index()) {
-                         nodeToReselect = node;
-                         break;
-                     }
-                     qreal dist = (node->pos() - oldPos).manhattanLength();
-                     if(dist < minDist) {
-                         minDist = dist;
-                         nodeToReselect = node;
-                     }
-                }
-            }
+    updateProfileVisibility(profile, isActiveProfile(profile));
+
+    if (isActiveProfile(profile)) {
+        for (quint32 id : selectedIds) {
+            int index = profile->indexOfNode(id);
+            if (index < 0) continue; // Deleted by the change
+            GraphNodeItem* node = m_nodeHandles.value(index);
+            if (!node) node = acquireNodeHandle(profile, index);
+            node->setSelected(true);
         }
     }
-    
-    m_scene->clearSelection();
-    if (nodeToReselect) {
-         nodeToReselect->setSelected(true);
+    m_restoringSelection = false;
+    onSceneSelectionChanged();
+}
+
+// Single-node edits shift the handle indices and patch the moved handle right
+// away (commands address nodes by index); the curve path is rebuilt once per frame
+void GraphEditorView::onProfileNodeInserted(int index) {
+    MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
+    if (!profile || !m_curveItems.contains(profile)) return;
+    scheduleProfileUpdate(profile, CurveDirty);
+    if (isActiveProfile(profile)) {
+        for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) {
+            if (handle->index() >= index) handle->setNodeIndex(handle->index() + 1);
+        }
+        rehashNodeHandles();
+        scheduleHandleUpdate(); // Binds a handle to a newly visible node
+        refreshSelectedNode(profile);
     }
-    emit nodeSelectionChanged(nodeToReselect);
-    update();
 }
 
-void GraphEditorView::onProfileConstraintsChanged() {
+void GraphEditorView::onProfileNodeRemoved(int index) {
     MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
-    if (profile) {
-         rebuildProfileItems(profile);
+    if (!profile || !m_curveItems.contains(profile)) return;
+    scheduleProfileUpdate(profile, CurveDirty);
+    if (isActiveProfile(profile)) {
+        if (GraphNodeItem* removed = m_nodeHandles.take(index)) releaseNodeHandle(removed);
+        for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) {
+            if (handle->index() > index) handle->setNodeIndex(handle->index() - 1);
+        }
+        rehashNodeHandles();
+        scheduleHandleUpdate(); // Binds a handle to a newly visible node
+        refreshSelectedNode(profile);
     }
-    if (profile && profile == (m_document ? m_document->activeProfile() : nullptr) ) {
-        update();
-     }
 }
 
+void GraphEditorView::onProfileNodeMoved(int from, int to) {
+    MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
+    if (!profile || !m_curveItems.contains(profile)) return;
+    scheduleProfileUpdate(profile, CurveDirty);
+    if (isActiveProfile(profile)) {
+        GraphNodeItem* moved = m_nodeHandles.value(from);
+        for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) {
+            int i = handle->index();
+            if (handle == moved) continue;
+            if (from < to && i > from && i <= to) handle->setNodeIndex(i - 1);
+            else if (to < from && i >= to && i < from) handle->setNodeIndex(i + 1);
+        }
+        if (moved) {
+            moved->setNodeIndex(to);
+            moved->updateFromModel();
+        }
+        rehashNodeHandles();
+        scheduleHandleUpdate(); // Binds a handle to a newly visible node
+        refreshSelectedNode(profile);
+    }
+}
 
-void GraphEditorView::rebuildProfileItems(MotorProfile* profile) {
-    if (!profile) return;
-    if (m_profileItems.contains(profile)) {
-        qDeleteAll(m_profileItems.value(profile));
-        m_profileItems[profile].clear();
-    } else {
-        m_profileItems.insert(profile, QList<QGraphicsItem*>());
+void GraphEditorView::onProfileConstraintsChanged() {
+    MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
+    if (profile) scheduleProfileUpdate(profile, ItemsDirty);
+}
+
+// Only the curve between the nodes changes shape
+void GraphEditorView::onProfileInterpolationChanged() {
+    MotorProfile* profile = qobject_cast<MotorProfile*>(sender());
+    if (profile && m_curveItems.contains(profile)) scheduleProfileUpdate(profile, CurveDirty);
+}
+
+// Keeps the node panel in sync when the single selected node was patched
+void GraphEditorView::refreshSelectedNode(MotorProfile* profile) {
+    auto selected = m_scene->selectedItems();
+    if (selected.size() != 1) return;
+    if (auto node = qgraphicsitem_cast<GraphNodeItem*>(selected.first())) {
+        if (node->profile() == profile) emit nodeSelectionChanged(node);
     }
+}
 
-    QList<QGraphicsItem*>& items = m_profileItems[profile];
-    const auto& nodes = profile->nodes();
-    QColor color = profile->color();
-    qreal motorScale = getMotorVisualScale(profile, m_referenceYValue);
-    if (qAbs(motorScale) < 1e-9) motorScale = 1.0;
+void GraphEditorView::updateCurve(MotorProfile* profile) {
+    if (ProfileCurveItem* curve = m_curveItems.value(profile)) curve->updateCurve();
+}
+
+bool GraphEditorView::updateCurveDetail(ProfileCurveItem* curve) const {
+    const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    return curve->setDetail(visible.left(), visible.right(), qAbs(transform().m11()));
+}
 
-    for (int i = 0; i < nodes.size() - 1; ++i) {
-        QPen linePen(color, 2);
-        linePen.setCosmetic(true);
-        const MotionNode& prevNode = nodes[i];
-        const MotionNode& currNode = nodes[i+1];
-        double deltaX = currNode.x() - prevNode.x();
-        if (qAbs(deltaX) > 1e-6) {
-            double deltaY = currNode.y() - prevNode.y();
-            double realSlope = deltaY / deltaX;
-            double maxSlopeLimit = profile->maxSlope();
-            if (maxSlopeLimit > 0 && qAbs(realSlope) > maxSlopeLimit) {
-                linePen.setStyle(Qt::DashLine);
+// Recomputes the curve (motor scale, slope styling) and the handle positions
+void GraphEditorView::rebuildProfileItems(MotorProfile* profile) {
+    if (!profile) return;
+    PERF_SCOPE("GraphEditorView::rebuildProfileItems");
+    PERF_COUNT("profile rebuilds", 1);
+    ProfileCurveItem*& curve = m_curveItems[profile];
+    if (!curve) {
+        curve = new ProfileCurveItem(profile);
+        m_scene->addItem(curve);
+        updateCurveDetail(curve);
+    }
+    curve->setYScale(getMotorVisualScale(profile, m_referenceYValue));
+    curve->updateCurve();
+
+    if (isActiveProfile(profile)) {
+        for (GraphNodeItem* handle : m_nodeHandles.values()) {
+            if (handle->index() >= profile->nodeCount()) {
+                m_nodeHandles.remove(handle->index());
+                releaseNodeHandle(handle);
+            } else {
+                handle->updateFromModel();
             }
         }
-        QGraphicsLineItem* line = m_scene->addLine(
-            QLineF(prevNode.x(), prevNode.y() * motorScale,
-                   currNode.x(), currNode.y() * motorScale),
-            linePen);
-        items.append(line);
-    }
-    for (int i = 0; i < nodes.size(); ++i) {
-        GraphNodeItem* nodeItem = new GraphNodeItem(profile, i, this, m_undoStack);
-        m_scene->addItem(nodeItem);
-        items.append(nodeItem);
+        updateNodeHandles();
     }
 }
 
 void GraphEditorView::rebuildAllItems() {
     if (!m_document) return;
-    clearAllProfileItems();
+    m_scene->clearSelection();
     MotorProfile* active = m_document ? m_document->activeProfile() : nullptr;
     for(MotorProfile* p : m_document->motorProfiles()){
         if(p) {
-            m_profileItems.insert(p, QList<QGraphicsItem*>());
             rebuildProfileItems(p);
             updateProfileVisibility(p, p == active);
         }
     }
-    m_scene->clearSelection();
     emit nodeSelectionChanged(nullptr);
 }
 
 
+void GraphEditorView::applyItemState(QGraphicsItem* item, bool isActive) {
+    item->setZValue(isActive ? 1 : 0);
+    item->setOpacity(isActive ? 1.0 : 0.6);
+    item->setEnabled(isActive);
+}
+
 void GraphEditorView::updateProfileVisibility(MotorProfile* profile, bool isActive) {
-    if (!profile || !m_profileItems.contains(profile)) return;
-    QList<QGraphicsItem*>& items = m_profileItems[profile];
+    PERF_SCOPE("GraphEditorView::updateProfileVisibility");
+    ProfileCurveItem* curve = m_curveItems.value(profile);
+    if (!curve) return;
     QColor color = profile->color();
-    qreal opacity;
-    int zValue;
-    if (isActive) {
-        opacity = 1.0;
-        zValue = 1;
+    if (!isActive) color.setAlpha(80);
+    applyItemState(curve, isActive);
+    curve->setColor(color);
+}
+
+
+// --- Node Handles ---
+void GraphEditorView::scrollContentsBy(int dx, int dy) {
+    QGraphicsView::scrollContentsBy(dx, dy);
+    scheduleHandleUpdate();
+}
+
+void GraphEditorView::resizeEvent(QResizeEvent* event) {
+    QGraphicsView::resizeEvent(event);
+    scheduleHandleUpdate();
+}
+
+bool GraphEditorView::isHandlePinned(GraphNodeItem* handle) const {
+    return handle->isSelected() || m_scene->mouseGrabberItem() == handle;
+}
+
+void GraphEditorView::rehashNodeHandles() {
+    QHash<int, GraphNodeItem*> byIndex;
+    byIndex.reserve(m_nodeHandles.size());
+    for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) byIndex.insert(handle->index(), handle);
+    m_nodeHandles.swap(byIndex);
+}
+
+GraphNodeItem* GraphEditorView::acquireNodeHandle(MotorProfile* profile, int index) {
+    GraphNodeItem* handle;
+    if (!m_handlePool.isEmpty()) {
+        handle = m_handlePool.takeLast();
+        handle->bind(profile, index);
+        handle->setVisible(true);
     } else {
-        color.setAlpha(80);
-        opacity = 0.6;
-        zValue = 0;
-    }
-    for (QGraphicsItem* item : items) {
-        if (!item) continue;
-        item->setZValue(zValue);
-        item->setOpacity(opacity);
-        item->setEnabled(isActive);
-        if (auto line = qgraphicsitem_cast<QGraphicsLineItem*>(item)) {
-            QPen currentPen = line->pen();
-            currentPen.setColor(color);
-            currentPen.setCosmetic(true);
-            line->setPen(currentPen);
-        } else if (auto node = qgraphicsitem_cast<GraphNodeItem*>(item)) {
-            node->setBrush(QBrush(color));
-            QPen nodePen(isActive ? Qt::black : color.darker(120), 1);
-            nodePen.setCosmetic(true);
-            node->setPen(nodePen);
+        handle = new GraphNodeItem(profile, index, this, m_undoStack);
+        QPen nodePen(Qt::black, 1);
+        nodePen.setCosmetic(true);
+        handle->setPen(nodePen);
+        handle->setZValue(2); // Above every curve
+        m_scene->addItem(handle);
+    }
+    m_nodeHandles.insert(index, handle);
+    return handle;
+}
+
+void GraphEditorView::releaseNodeHandle(GraphNodeItem* handle) {
+    handle->setSelected(false);
+    handle->setVisible(false); // Stays in the scene, ready for reuse
+    handle->bind(nullptr, -1);
+    m_handlePool.append(handle);
+}
+
+void GraphEditorView::releaseAllNodeHandles() {
+    for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) releaseNodeHandle(handle);
+    m_nodeHandles.clear();
+}
+
+// Deletes idle handles beyond MAX_POOLED_HANDLES once a frame's handle sync is
+// done (e.g. after zooming out of a dense region or switching motors)
+void GraphEditorView::trimHandlePool() {
+    while (m_handlePool.size() > MAX_POOLED_HANDLES) {
+        GraphNodeItem* handle = m_handlePool.takeLast();
+        m_dragStartPositions.remove(handle);
+        delete handle; // Also removes it from the scene
+    }
+}
+
+// The cursor's X while it is over the view, else the X of a selected (or
+// dragged) node, else the middle of the view
+double GraphEditorView::handleAnchorX(const QRectF& visible) const {
+    const QPoint cursor = viewport()->mapFromGlobal(QCursor::pos());
+    if (viewport()->rect().contains(cursor)) return mapToScene(cursor).x();
+    for (GraphNodeItem* handle : qAsConst(m_nodeHandles)) {
+        if (isHandlePinned(handle)) return handle->pos().x();
+    }
+    return visible.center().x();
+}
+
+// Binds handles to the active profile's nodes in the visible X range (plus a
+// handle radius) and returns the others to the pool, except pinned ones
+void GraphEditorView::updateNodeHandles() {
+    PERF_SCOPE("GraphEditorView::updateNodeHandles");
+    MotorProfile* profile = m_document ? m_document->activeProfile() : nullptr;
+    if (!profile || !m_curveItems.contains(profile)) {
+        releaseAllNodeHandles();
+        trimHandlePool();
+        return;
+    }
+
+    const QVector<MotionNode>& nodes = profile->nodes();
+    const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    const qreal pixelsPerUnit = qAbs(transform().m11());
+    const qreal margin = pixelsPerUnit > 1e-12 ? 10.0 / pixelsPerUnit : 0.0; // Handle radius
+    auto byX = [](const MotionNode& node, double x) { return node.x() < x; };
+    int first = int(std::lower_bound(nodes.begin(), nodes.end(), visible.left() - margin, byX) - nodes.begin());
+    int last = int(std::lower_bound(nodes.begin(), nodes.end(), visible.right() + margin, byX) - nodes.begin()) - 1;
+    m_handlesLimited = last - first + 1 > MAX_NODE_HANDLES;
+    if (m_handlesLimited) {
+        // Too dense to show every handle: keep the MAX_NODE_HANDLES nodes
+        // nearest the anchor in X, grown outwards from it one node at a time
+        const double anchor = handleAnchorX(visible);
+        int from = int(std::lower_bound(nodes.begin() + first, nodes.begin() + last + 1, anchor, byX) - nodes.begin());
+        int to = from; // Window [from, to)
+        while (to - from < MAX_NODE_HANDLES) {
+            if (from == first) ++to;
+            else if (to > last) --from;
+            else if (anchor - nodes[from - 1].x() <= nodes[to].x() - anchor) --from;
+            else ++to;
+        }
+        first = from;
+        last = to - 1;
+    }
+
+    for (GraphNodeItem* handle : m_nodeHandles.values()) {
+        int i = handle->index();
+        if ((i < first || i > last) && !isHandlePinned(handle)) {
+            m_nodeHandles.remove(i);
+            releaseNodeHandle(handle);
         }
     }
+    for (int i = first; i <= last; ++i) {
+        if (!m_nodeHandles.contains(i)) acquireNodeHandle(profile, i);
+    }
+    trimHandlePool();
+}
+
+
+// --- Group Drag ---
+// Called by the pressed handle after Qt updated the selection: every selected
+// handle moves with it, so all of them are recorded
+void GraphEditorView::beginNodeDrag() {
+    m_dragStartPositions.clear();
+    for (QGraphicsItem* item : m_scene->selectedItems()) {
+        if (auto handle = qgraphicsitem_cast<GraphNodeItem*>(item)) {
+            if (handle->profile()) m_dragStartPositions.insert(handle, { handle->nodeId(), handle->pos() });
+        }
+    }
+}
+
+// Commits the handles that moved: one MoveNodeCommand for a single node (so
+// consecutive drags still merge), otherwise one batch and one BatchEditCommand
+void GraphEditorView::endNodeDrag() {
+    QHash<GraphNodeItem*, DragStart> starts;
+    starts.swap(m_dragStartPositions);
+    MotorProfile* profile = m_document ? m_document->activeProfile() : nullptr;
+    if (!profile || !m_undoStack) return;
+
+    qreal motorScale = getMotorVisualScale(profile, m_referenceYValue);
+    if (qAbs(motorScale) < 1e-9) motorScale = 1.0;
+    QVector<QPair<quint32, MotionNode>> moves;
+    for (auto it = starts.constBegin(); it != starts.constEnd(); ++it) {
+        GraphNodeItem* handle = it.key();
+        if (handle->profile() != profile || handle->pos() == it.value().scenePos) continue;
+        QPointF newScenePos = handle->pos();
+        MotionNode newRealPos(newScenePos.x(), qBound(profile->yMin(), newScenePos.y() / motorScale, profile->yMax()));
+        moves.append(qMakePair(it.value().nodeId, newRealPos));
+    }
+    if (moves.isEmpty()) return;
+
+    if (moves.size() == 1) {
+        int index = profile->indexOfNode(moves.first().first);
+        if (index < 0) return;
+        m_undoStack->push(new MoveNodeCommand(profile, index, profile->nodeAt(index), moves.first().second));
+        return;
+    }
+    profile->beginBatch();
+    for (const auto& move : moves) {
+        int index = profile->indexOfNode(move.first);
+        if (index >= 0) profile->internalMoveNode(index, move.second);
+    }
+    QVector<NodeChange> changes = profile->commitBatch();
+    if (changes.isEmpty()) return;
+    m_undoStack->push(new BatchEditCommand(profile, changes, QString("Move %1 Nodes").arg(moves.size())));
+}
+
+
+// --- Frame Scheduler ---
+// Model signals and view events only record what is dirty; processFrame()
+// applies it once per frame, so bursts of edits (an undo of a batch, a wheel
+// spin, a drag) cost one curve rebuild, one handle sync and one repaint
+void GraphEditorView::scheduleFrame() {
+    if (!m_frameTimer.isActive()) m_frameTimer.start();
+}
+
+void GraphEditorView::scheduleProfileUpdate(MotorProfile* profile, int flags) {
+    m_dirtyProfiles[profile] |= flags;
+    scheduleFrame();
+}
+
+void GraphEditorView::scheduleHandleUpdate() {
+    m_handlesDirty = true;
+    scheduleFrame();
+}
+
+void GraphEditorView::scheduleRepaint() {
+    m_repaintPending = true;
+    scheduleFrame();
+}
+
+void GraphEditorView::flushPendingFrame() {
+    m_frameTimer.stop();
+    processFrame();
+}
+
+void GraphEditorView::processFrame() {
+    PERF_SCOPE("GraphEditorView::processFrame");
+    PERF_COUNT("frames", 1);
+    if (m_handlesDirty) { // The view may have scrolled or zoomed: curved polylines follow
+        for (auto it = m_curveItems.constBegin(); it != m_curveItems.constEnd(); ++it) {
+            if (updateCurveDetail(it.value())) m_dirtyProfiles[it.key()] |= CurveDirty;
+        }
+    }
+    const QHash<MotorProfile*, int> dirtyProfiles = m_dirtyProfiles;
+    m_dirtyProfiles.clear();
+    for (auto it = dirtyProfiles.constBegin(); it != dirtyProfiles.constEnd(); ++it) {
+        MotorProfile* profile = it.key();
+        if (!m_curveItems.contains(profile)) continue; // Removed in the meantime
+        if (it.value() & SelectionDirty) {
+            applyProfileDataChange(profile);
+        } else if (it.value() & ItemsDirty) {
+            rebuildProfileItems(profile);
+        } else if (it.value() & CurveDirty) {
+            updateCurve(profile);
+        }
+    }
+    if (m_handlesDirty) {
+        m_handlesDirty = false;
+        updateNodeHandles();
+    }
+    if (m_repaintPending || !dirtyProfiles.isEmpty()) {
+        m_repaintPending = false;
+        viewport()->update(); // Background and limit lines may depend on the profiles
+    }
+    PERF_GAUGE("curve items", m_curveItems.size());
+    PERF_GAUGE("node handles", m_nodeHandles.size());
+    PERF_GAUGE("pooled handles", m_handlePool.size());
 }
 
 
@@ -489,7 +826,7 @@ void GraphEditorView::applyFitting(double xMin, double xMax) {
     double xMargin = qAbs(targetSceneRect.width()) * xMarginFactor;
     fitInView(targetSceneRect.marginsAdded(QMarginsF(xMargin, yMargin, xMargin, yMargin)), Qt::KeepAspectRatio);
     centerOn(targetSceneRect.left() + targetSceneRect.width() / 2.0, 0);
-    update();
+    scheduleHandleUpdate();
 }
 
 // --- Public Fitting Slots ---
@@ -552,7 +889,7 @@ void GraphEditorView::setNumYDivisions(int divisions) {
     if (divisions < 1) divisions = 1;
     if (divisions != m_numYDivisions) {
         m_numYDivisions = divisions;
-        update();
+        scheduleRepaint();
     }
 }
 
@@ -561,7 +898,6 @@ void GraphEditorView::setReferenceYValue(double value) {
     if (value > 0 && qAbs(m_referenceYValue - value) > 1e-6) {
         m_referenceYValue = value;
         rebuildAllItems();
-        update();
         // Re-apply current X range fit
         QRectF currentSceneRect = mapToScene(viewport()->rect()).boundingRect();
         applyFitting(currentSceneRect.left(), currentSceneRect.right());
@@ -572,7 +908,7 @@ void GraphEditorView::setReferenceYValue(double value) {
 void GraphEditorView::setGridSizeX(double size) {
      if (size > 0 && qAbs(m_gridSizeX - size) > 1e-6) {
          m_gridSizeX = size;
-         update();
+         scheduleRepaint();
      }
 }
 
@@ -580,7 +916,7 @@ void GraphEditorView::setGridSizeX(double size) {
 void GraphEditorView::setGridLargeSizeX(double size) {
      if (size > 0 && qAbs(m_gridLargeSizeX - size) > 1e-6) {
          m_gridLargeSizeX = size;
-         update();
+         scheduleRepaint();
      }
 }
 
@@ -591,6 +927,7 @@ void GraphEditorView::setGridLargeSizeX(double size) {
 // Slot connected to scene selection changes
 void GraphEditorView::onSceneSelectionChanged()
 {
+    if (m_restoringSelection) return; // Reported once when done
     auto selected = m_scene->selectedItems();
     QGraphicsItem* selectedNodeItem = nullptr;
 
@@ -2,24 +2,41 @@
 
 #include <QGraphicsView>
 #include <QMap>
+#include <QHash>
 #include <QList>
 #include <qmath.h> // qFloor, qBound, qMax, qAbs, qSqrt, fmod
 #include <QGraphicsItem> // Base class for items
+#include <QPixmap>
+#include <QColor> // QRgb
+#include <QTransform>
+#include <QTimer>
 
 // Forward declarations
 class MotionDocument;
 class MotorProfile;
-class QUndoStack;
+class UndoHistory;
 class QKeyEvent;
 class QPainter;
 class QWheelEvent;
 class QMouseEvent;
 class QContextMenuEvent; // <-- Correct type for QWidget event
+class QResizeEvent;
 class GraphNodeItem; // Added forward declaration
+class ProfileCurveItem;
 
 // Constants for visual scaling and default behavior
 const qreal VISUAL_Y_TARGET = 300.0; // The scene Y-coordinate corresponding to the reference Y value
 const qreal DEFAULT_REFERENCE_Y = 100.0; // Default reference Y value
+// Above this many nodes in view, only the handles nearest the cursor (or the
+// selection) are shown, the rest after zooming in
+const int MAX_NODE_HANDLES = 5000;
+// Idle handles kept for reuse; the pool is trimmed to this after large releases
+const int MAX_POOLED_HANDLES = 256;
+// Deferred scene work is applied at most once per display frame (~60 Hz)
+const int FRAME_INTERVAL_MS = 16;
+// The grid cache extends this many pixels past each viewport edge, so pans
+// within that distance blit the cached grid instead of re-rendering it
+const int GRID_CACHE_MARGIN = 256;
 
 // Main view class
 class GraphEditorView : public QGraphicsView {
@@ -30,7 +47,7 @@ public:
 
     // Setters
     void setDocument(MotionDocument* doc);
-    void setUndoStack(QUndoStack* stack) { m_undoStack = stack; }
+    void setUndoStack(UndoHistory* stack) { m_undoStack = stack; }
 
     // Getters
     bool isSnapEnabled() const { return m_snapToGrid; }
@@ -40,6 +57,15 @@ public:
     double getReferenceYValue() const { return m_referenceYValue; }
     double getMajorGridSizeX() const { return m_gridLargeSizeX; }
 
+    // Group drag of the selected node handles (called by GraphNodeItem);
+    // the moves are committed as one undo step
+    void beginNodeDrag();
+    void endNodeDrag();
+
+    // Applies the pending frame now instead of on the frame timer (for
+    // benchmarks and other code running without an event loop)
+    void flushPendingFrame();
+
 public slots:
     // View control
     void fitToView();
@@ -66,27 +92,89 @@ protected:
     void contextMenuEvent(QContextMenuEvent* event) override; // <-- Correct type
     void keyPressEvent(QKeyEvent* event) override;
     void drawBackground(QPainter* painter, const QRectF& rect) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent* event) override;
 
 private slots:
     void onDocumentCleared();
     void onMotorAdded(MotorProfile* profile);
     void onActiveMotorChanged(MotorProfile* active, MotorProfile* previous);
     void onProfileDataChanged();
+    void onProfileNodeInserted(int index);
+    void onProfileNodeRemoved(int index);
+    void onProfileNodeMoved(int from, int to);
     void onProfileConstraintsChanged();
+    void onProfileInterpolationChanged();
     void onSceneSelectionChanged();
+    void processFrame(); // Applies the work collected since the last frame
 
 private:
+    // Everything the cached grid layer depends on
+    struct GridCacheKey {
+        QTransform transform; // Scene to viewport, without the whole-pixel translation
+        QSize viewportSize;
+        qreal devicePixelRatio = 1.0;
+        double gridSizeX = 0.0;
+        double gridLargeSizeX = 0.0;
+        int numYDivisions = 0;
+        double referenceYValue = 0.0;
+        bool hasActiveProfile = false; // Limit lines and Y labels follow the active motor
+        double yMin = 0.0;
+        double yMax = 0.0;
+        QRgb color = 0;
+
+        bool operator==(const GridCacheKey& o) const {
+            return transform == o.transform && viewportSize == o.viewportSize
+                && devicePixelRatio == o.devicePixelRatio && gridSizeX == o.gridSizeX
+                && gridLargeSizeX == o.gridLargeSizeX && numYDivisions == o.numYDivisions
+                && referenceYValue == o.referenceYValue && hasActiveProfile == o.hasActiveProfile
+                && yMin == o.yMin && yMax == o.yMax && color == o.color;
+        }
+    };
+
+    // Per-profile work deferred to the next frame
+    enum DirtyFlag {
+        CurveDirty = 0x1,     // Node data changed: rebuild the curve path
+        ItemsDirty = 0x2,     // Scale or constraints changed: curve and handle positions
+        SelectionDirty = 0x4  // Bulk data change: also re-bind handles and the selection
+    };
+
     // Helper function
     void applyFitting(double xMin, double xMax);
+    void paintGrid(QPainter* painter, const QRectF& rect);
 
     // Internal functions
     void rebuildProfileItems(MotorProfile* profile);
     void rebuildAllItems();
     void updateProfileVisibility(MotorProfile* profile, bool isActive);
     void clearAllProfileItems();
+    bool isActiveProfile(MotorProfile* profile) const;
+    void updateCurve(MotorProfile* profile);
+    // Passes the visible range and zoom to 'curve'; true if it needs updateCurve()
+    bool updateCurveDetail(ProfileCurveItem* curve) const;
+    void applyItemState(QGraphicsItem* item, bool isActive);
+    void refreshSelectedNode(MotorProfile* profile);
+    void applyProfileDataChange(MotorProfile* profile);
+
+    // Frame scheduler
+    void scheduleFrame();
+    void scheduleProfileUpdate(MotorProfile* profile, int flags);
+    void scheduleHandleUpdate();
+    void scheduleRepaint();
+
+    // Node handles: only the active profile's nodes in the visible X range get a
+    // GraphNodeItem. Handles are recycled through a pool of hidden items.
+    void updateNodeHandles();
+    double handleAnchorX(const QRectF& visible) const; // Where handles are kept when the view is too dense
+    void releaseAllNodeHandles();
+    void releaseNodeHandle(GraphNodeItem* handle);
+    void trimHandlePool();
+    GraphNodeItem* acquireNodeHandle(MotorProfile* profile, int index);
+    bool isHandlePinned(GraphNodeItem* handle) const; // Selected or being dragged
+    void rehashNodeHandles();
 
     // Pointers
-    QUndoStack* m_undoStack = nullptr;
+    UndoHistory* m_undoStack = nullptr;
     MotionDocument* m_document = nullptr;
     QGraphicsScene* m_scene;
 
@@ -98,14 +186,34 @@ private:
     double m_referenceYValue = DEFAULT_REFERENCE_Y;
     double m_gridLargeSizeX = 1000.0;
 
-    // Item map
-    QMap<MotorProfile*, QList<QGraphicsItem*>> m_profileItems;
+    // Item map: one curve item per profile
+    QMap<MotorProfile*, ProfileCurveItem*> m_curveItems;
+    // Node handles of the active profile by node index, and the idle pool
+    QHash<int, GraphNodeItem*> m_nodeHandles;
+    QList<GraphNodeItem*> m_handlePool;
+
+    // Frame scheduler state
+    QTimer m_frameTimer;
+    QHash<MotorProfile*, int> m_dirtyProfiles; // DirtyFlag bits
+    bool m_handlesDirty = false;
+    bool m_handlesLimited = false; // More nodes in view than MAX_NODE_HANDLES: handles follow the cursor
+    bool m_repaintPending = false;
+
+    // Grid layer cache (see drawBackground)
+    QPixmap m_gridCache;
+    GridCacheKey m_gridCacheKey;
+    QPoint m_gridCacheTranslation; // Whole-pixel view translation the cache was rendered at
 
     // Panning state
     bool m_isPanning = false;
     QPoint m_panStartPos;
     
-    // Multi-move state REMOVED
-    // QMap<GraphNodeItem*, QPointF> m_dragStartPositions;
+    // Group drag state: where each dragged handle started, and its node
+    struct DragStart {
+        quint32 nodeId;
+        QPointF scenePos;
+    };
+    QHash<GraphNodeItem*, DragStart> m_dragStartPositions;
+    bool m_restoringSelection = false; // Suppresses per-item selection reports
 };
 
@@ -2,7 +2,7 @@
 #include "grapheditorview.h" // Needed for view properties and constants
 #include "motionmodels.h"     // Needed for MotorProfile definition
 #include "commands.h"         // For undo commands
-#include <QUndoStack>
+#include "undohistory.h"
 #include <QGraphicsSceneMouseEvent>
 #include <QGraphicsSceneContextMenuEvent>
 #include <QMenu>
@@ -25,11 +25,12 @@ inline qreal getMotorVisualScale(MotorProfile* profile, double referenceYValue)
 
 // Constructor implementation
 GraphNodeItem::GraphNodeItem(MotorProfile* profile, int index,
-                             GraphEditorView* view, QUndoStack* stack,
+                             GraphEditorView* view, UndoHistory* stack,
                              QGraphicsItem* parent)
     : QObject(nullptr),
       QGraphicsEllipseItem(parent),
       m_profile(profile), m_nodeIndex(index),
+      m_nodeId(profile ? profile->nodeId(index) : 0),
       m_view(view), m_undoStack(stack)
 {
     setRect(-10, -10, 20, 20); // Node diameter 20px
@@ -45,45 +46,41 @@ GraphNodeItem::GraphNodeItem(MotorProfile* profile, int index,
 
     // Set initial position
     if (m_profile && m_view && m_nodeIndex >= 0 && m_nodeIndex < m_profile->nodeCount()) {
-        MotionNode realNode = m_profile->nodeAt(m_nodeIndex);
-        qreal motorScale = getMotorVisualScale(m_profile, m_view->getReferenceYValue());
-        setPos(realNode.x(), realNode.y() * motorScale);
+        updateFromModel();
     } else {
         qWarning() << "GraphNodeItem created with invalid profile, view, or index.";
         setPos(0,0);
     }
 }
 
-// <<< mousePressEvent 구현 복원 >>>
+void GraphNodeItem::bind(MotorProfile* profile, int index) {
+    m_profile = profile;
+    m_nodeIndex = index;
+    m_nodeId = profile ? profile->nodeId(index) : 0;
+    setBrush(QBrush(profile ? profile->color() : Qt::gray));
+    updateFromModel();
+}
+
+void GraphNodeItem::updateFromModel() {
+    if (!m_profile || !m_view || m_nodeIndex < 0 || m_nodeIndex >= m_profile->nodeCount()) return;
+    MotionNode realNode = m_profile->nodeAt(m_nodeIndex);
+    qreal motorScale = getMotorVisualScale(m_profile, m_view->getReferenceYValue());
+    m_updatingFromModel = true;
+    setPos(realNode.x(), realNode.y() * motorScale);
+    m_updatingFromModel = false;
+}
+
 void GraphNodeItem::mousePressEvent(QGraphicsSceneMouseEvent* event) {
-    if (event->button() == Qt::LeftButton) {
-        m_dragStartPosition = pos(); // Record current scene position
+    QGraphicsEllipseItem::mousePressEvent(event); // Updates the selection first
+    if (event->button() == Qt::LeftButton && m_view) {
+        m_view->beginNodeDrag(); // Records every selected handle, not just this one
     }
-    QGraphicsEllipseItem::mousePressEvent(event); // Call base class
 }
 
-// <<< mouseReleaseEvent 구현 복원 (단일 MoveNodeCommand 사용) >>>
 void GraphNodeItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
     QGraphicsEllipseItem::mouseReleaseEvent(event);
-
-    if (event->button() == Qt::LeftButton && pos() != m_dragStartPosition) {
-        if (!m_profile || !m_undoStack || !m_view) return;
-
-        if (m_nodeIndex < 0 || m_nodeIndex >= m_profile->nodeCount()) {
-             qWarning() << "Node index" << m_nodeIndex << "is invalid on mouse release.";
-             setPos(m_dragStartPosition);
-             return;
-        }
-
-        QPointF oldRealPos = m_profile->nodeAt(m_nodeIndex);
-        QPointF newScenePos = pos();
-        qreal motorScale = getMotorVisualScale(m_profile, m_view->getReferenceYValue());
-        if (qAbs(motorScale) < 1e-9) motorScale = 1.0;
-        QPointF newRealPos(newScenePos.x(), newScenePos.y() / motorScale);
-        newRealPos.setY(qBound(m_profile->yMin(), newRealPos.y(), m_profile->yMax()));
-
-        // Push the *single* MoveNodeCommand
-        m_undoStack->push(new MoveNodeCommand(m_profile, m_nodeIndex, oldRealPos, newRealPos));
+    if (event->button() == Qt::LeftButton && m_view) {
+        m_view->endNodeDrag();
     }
 }
 
@@ -110,7 +107,7 @@ void GraphNodeItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *event) {
 
 // Handles position changes during dragging (snapping, constraints)
 QVariant GraphNodeItem::itemChange(GraphicsItemChange change, const QVariant& value) {
-    if (change == ItemPositionChange && scene() && m_profile && m_view) {
+    if (change == ItemPositionChange && !m_updatingFromModel && scene() && m_profile && m_view) {
         QPointF newScenePos = value.toPointF();
         qreal motorScale = getMotorVisualScale(m_profile, m_view->getReferenceYValue());
         if (qAbs(motorScale) < 1e-9) motorScale = 1.0;
@@ -7,7 +7,7 @@
 // Forward declarations
 class MotorProfile;
 class GraphEditorView;
-class QUndoStack;
+class UndoHistory;
 class QGraphicsSceneMouseEvent;
 class QGraphicsSceneContextMenuEvent;
 
@@ -21,18 +21,23 @@ class GraphNodeItem : public QObject, public QGraphicsEllipseItem {
 
 public:
     GraphNodeItem(MotorProfile* profile, int index,
-                  GraphEditorView* view, QUndoStack* stack,
+                  GraphEditorView* view, UndoHistory* stack,
                   QGraphicsItem* parent = nullptr);
 
     // Getters
     MotorProfile* profile() const { return m_profile; }
     int index() const { return m_nodeIndex; }
-    void setNodeIndex(int index) { m_nodeIndex = index; }
+    void setNodeIndex(int index) { m_nodeIndex = index; } // Same node, shifted
+    quint32 nodeId() const { return m_nodeId; } // Stable ID of the node (see MotorProfile::nodeId)
+    // Re-targets a pooled item at another node (sets brush and position)
+    void bind(MotorProfile* profile, int index);
+    // Moves the item to its node's current model position (no snapping/clamping)
+    void updateFromModel();
 
 protected:
     // Event handlers for interaction
     void contextMenuEvent(QGraphicsSceneContextMenuEvent *event) override;
-    // <<< 단일 드래그를 위해 이벤트 핸들러 복원 >>>
+    // Drags of the selected handles are committed by the view (see GraphEditorView::endNodeDrag)
     void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
     void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
     QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
@@ -43,10 +48,10 @@ private slots:
 private:
     MotorProfile* m_profile;
     int m_nodeIndex;
-    // <<< 단일 드래그 시작 위치 저장을 위해 복원 >>>
-    QPointF m_dragStartPosition; 
-    
+    quint32 m_nodeId = 0;
+
     GraphEditorView* m_view;
-    QUndoStack* m_undoStack;
+    UndoHistory* m_undoStack;
+    bool m_updatingFromModel = false; // Bypasses itemChange() adjustments
 };
 
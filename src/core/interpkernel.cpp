@@ -0,0 +1,169 @@
+#include "interpkernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MOTION_INTERP_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> // __cpuid, _xgetbv
+#define MOTION_TARGET_SSE2
+#define MOTION_TARGET_AVX
+#else
+#define MOTION_TARGET_SSE2 __attribute__((target("sse2")))
+#define MOTION_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+// --- Scalar kernel (reference) ---
+static void linearRunScalar(double x0, double y0, double x1, double y1,
+                            double t0, double dt, int first, int count, double* out) {
+    const double dx = x1 - x0;
+    for (int k = 0; k < count; ++k) {
+        double time = t0 + (first + k) * dt;
+        double t = (time - x0) / dx;
+        out[k] = y0 * (1.0 - t) + y1 * t;
+    }
+}
+
+#ifdef MOTION_INTERP_X86
+// --- SSE2 kernel: 2 samples per iteration ---
+MOTION_TARGET_SSE2
+static void linearRunSSE2(double x0, double y0, double x1, double y1,
+                          double t0, double dt, int first, int count, double* out) {
+    const __m128d vx0 = _mm_set1_pd(x0);
+    const __m128d vdx = _mm_set1_pd(x1 - x0);
+    const __m128d vy0 = _mm_set1_pd(y0);
+    const __m128d vy1 = _mm_set1_pd(y1);
+    const __m128d vone = _mm_set1_pd(1.0);
+    const __m128d vt0 = _mm_set1_pd(t0);
+    const __m128d vdt = _mm_set1_pd(dt);
+    const __m128d vstep = _mm_set1_pd(2.0);
+    __m128d vindex = _mm_set_pd(double(first) + 1.0, double(first));
+
+    int k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128d time = _mm_add_pd(vt0, _mm_mul_pd(vindex, vdt));
+        __m128d t = _mm_div_pd(_mm_sub_pd(time, vx0), vdx);
+        __m128d y = _mm_add_pd(_mm_mul_pd(vy0, _mm_sub_pd(vone, t)), _mm_mul_pd(vy1, t));
+        _mm_storeu_pd(out + k, y);
+        vindex = _mm_add_pd(vindex, vstep);
+    }
+    if (k < count) linearRunScalar(x0, y0, x1, y1, t0, dt, first + k, count - k, out + k);
+}
+
+// --- AVX kernel: 4 samples per iteration ---
+MOTION_TARGET_AVX
+static void linearRunAVX(double x0, double y0, double x1, double y1,
+                         double t0, double dt, int first, int count, double* out) {
+    const __m256d vx0 = _mm256_set1_pd(x0);
+    const __m256d vdx = _mm256_set1_pd(x1 - x0);
+    const __m256d vy0 = _mm256_set1_pd(y0);
+    const __m256d vy1 = _mm256_set1_pd(y1);
+    const __m256d vone = _mm256_set1_pd(1.0);
+    const __m256d vt0 = _mm256_set1_pd(t0);
+    const __m256d vdt = _mm256_set1_pd(dt);
+    const __m256d vstep = _mm256_set1_pd(4.0);
+    __m256d vindex = _mm256_set_pd(double(first) + 3.0, double(first) + 2.0,
+                                   double(first) + 1.0, double(first));
+
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d time = _mm256_add_pd(vt0, _mm256_mul_pd(vindex, vdt));
+        __m256d t = _mm256_div_pd(_mm256_sub_pd(time, vx0), vdx);
+        __m256d y = _mm256_add_pd(_mm256_mul_pd(vy0, _mm256_sub_pd(vone, t)), _mm256_mul_pd(vy1, t));
+        _mm256_storeu_pd(out + k, y);
+        vindex = _mm256_add_pd(vindex, vstep);
+    }
+    if (k < count) linearRunScalar(x0, y0, x1, y1, t0, dt, first + k, count - k, out + k);
+}
+
+static bool cpuSupportsSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return true; // Part of the x86-64 baseline
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static bool cpuSupportsAVX() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    return (_xgetbv(0) & 0x6) == 0x6; // OS saves XMM and YMM state
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx");
+#endif
+}
+#endif // MOTION_INTERP_X86
+
+static LinearRunKernel kernelFor(SimdLevel level) {
+    switch (level) {
+#ifdef MOTION_INTERP_X86
+    case SimdLevel::AVX: return linearRunAVX;
+    case SimdLevel::SSE2: return linearRunSSE2;
+#endif
+    default: return linearRunScalar;
+    }
+}
+
+static bool isSupported(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return true;
+#ifdef MOTION_INTERP_X86
+    case SimdLevel::SSE2: return cpuSupportsSSE2();
+    case SimdLevel::AVX: return cpuSupportsAVX();
+#endif
+    default: return false;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = isSupported(SimdLevel::AVX) ? SimdLevel::AVX
+                                    : isSupported(SimdLevel::SSE2) ? SimdLevel::SSE2
+                                    : SimdLevel::Scalar;
+    return detected;
+}
+
+// Selected on first use; only changed explicitly through setActiveSimdLevel()
+static SimdLevel& activeLevelRef() {
+    static SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+static LinearRunKernel& activeKernelRef() {
+    static LinearRunKernel kernel = kernelFor(activeLevelRef());
+    return kernel;
+}
+
+SimdLevel activeSimdLevel() {
+    return activeLevelRef();
+}
+
+bool setActiveSimdLevel(SimdLevel level) {
+    if (!isSupported(level)) return false;
+    activeLevelRef() = level;
+    activeKernelRef() = kernelFor(level);
+    return true;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX: return "avx";
+    case SimdLevel::SSE2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+void interpolateLinearRun(double x0, double y0, double x1, double y1,
+                          double t0, double dt, int first, int count, double* out) {
+    if (count <= 0) return;
+    activeKernelRef()(x0, y0, x1, y1, t0, dt, first, count, out);
+}
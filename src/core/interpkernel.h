@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @brief Dense linear interpolation kernels for evenly spaced sample times.
+ * Inside one segment (x0, y0) -> (x1, y1) the kernel writes, for k in [0, count):
+ *   time   = t0 + (first + k) * dt
+ *   t      = (time - x0) / (x1 - x0)
+ *   out[k] = y0 * (1 - t) + y1 * t
+ * The SIMD variants evaluate the same operations in the same order as the
+ * scalar one, so all kernels produce bit-identical results.
+ * The best kernel supported by the CPU is picked at runtime.
+ */
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX
+};
+
+// Signature shared by all kernel variants (x1 - x0 must not be ~0)
+using LinearRunKernel = void (*)(double x0, double y0, double x1, double y1,
+                                 double t0, double dt, int first, int count, double* out);
+
+// Evaluates one segment run with the active kernel
+void interpolateLinearRun(double x0, double y0, double x1, double y1,
+                          double t0, double dt, int first, int count, double* out);
+
+// Highest SIMD level usable on this CPU (and build)
+SimdLevel detectSimdLevel();
+// Currently selected level (defaults to detectSimdLevel())
+SimdLevel activeSimdLevel();
+// Forces a level (e.g. for benchmarks); returns false if the CPU cannot run it
+bool setActiveSimdLevel(SimdLevel level);
+// Human readable name ("scalar", "sse2", "avx")
+const char* simdLevelName(SimdLevel level);
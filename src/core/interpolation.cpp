@@ -0,0 +1,369 @@
+#include "interpolation.h"
+#include <cmath>   // std::copysign
+#include <limits>  // std::numeric_limits
+#include <qmath.h> // qAbs
+
+// Same threshold ProfileSampler::interpolate uses for vertical segments
+static const double MIN_SEGMENT_LENGTH = 1e-6;
+
+struct ModeInfo {
+    const char* name;
+    const char* label;
+};
+
+static const ModeInfo MODE_INFO[INTERPOLATION_MODE_COUNT] = {
+    { "linear", "Linear" },
+    { "natural_cubic", "Natural Cubic Spline" },
+    { "clamped_cubic", "Clamped Cubic Spline" },
+    { "pchip", "Monotone Cubic (PCHIP)" },
+    { "s_curve", "S-Curve (Rest to Rest)" },
+};
+
+const char* interpolationModeName(InterpolationMode mode) {
+    const int index = int(mode);
+    return index >= 0 && index < INTERPOLATION_MODE_COUNT ? MODE_INFO[index].name : MODE_INFO[0].name;
+}
+
+QString interpolationModeLabel(InterpolationMode mode) {
+    const int index = int(mode);
+    return QString::fromLatin1(index >= 0 && index < INTERPOLATION_MODE_COUNT ? MODE_INFO[index].label
+                                                                              : MODE_INFO[0].label);
+}
+
+bool parseInterpolationMode(const QString& name, InterpolationMode* mode) {
+    for (int i = 0; i < INTERPOLATION_MODE_COUNT; ++i) {
+        if (name == QLatin1String(MODE_INFO[i].name)) {
+            if (mode) *mode = InterpolationMode(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Cubic Hermite segment from the end values and end slopes (per ms)
+static SegmentPolynomial hermiteSegment(double y0, double y1, double m0, double m1, double length) {
+    SegmentPolynomial poly = {};
+    const double s0 = m0 * length; // Slopes in normalized time
+    const double s1 = m1 * length;
+    poly.c[0] = y0;
+    poly.c[1] = s0;
+    poly.c[2] = 3.0 * (y1 - y0) - 2.0 * s0 - s1;
+    poly.c[3] = 2.0 * (y0 - y1) + s0 + s1;
+    poly.invLength = 1.0 / length;
+    return poly;
+}
+
+// Node slopes of a C2 cubic spline through nodes [first, last] (strictly
+// increasing X), in slope form: a tridiagonal system solved with the Thomas
+// algorithm. Natural ends have zero curvature, clamped ends zero slope.
+static void splineSlopes(const MotionNode* nodes, int count, bool clamped, double* slopes) {
+    if (count == 2) {
+        const double d = (nodes[1].y() - nodes[0].y()) / (nodes[1].x() - nodes[0].x());
+        slopes[0] = slopes[1] = clamped ? 0.0 : d;
+        return;
+    }
+    // Row i: sub[i] m[i-1] + diag[i] m[i] + sup[i] m[i+1] = rhs[i]
+    QVector<double> sub(count), diag(count), sup(count), rhs(count);
+    for (int i = 1; i + 1 < count; ++i) {
+        const double h0 = nodes[i].x() - nodes[i - 1].x();
+        const double h1 = nodes[i + 1].x() - nodes[i].x();
+        const double d0 = (nodes[i].y() - nodes[i - 1].y()) / h0;
+        const double d1 = (nodes[i + 1].y() - nodes[i].y()) / h1;
+        sub[i] = h1;
+        diag[i] = 2.0 * (h0 + h1);
+        sup[i] = h0;
+        rhs[i] = 3.0 * (h1 * d0 + h0 * d1);
+    }
+    const int last = count - 1;
+    if (clamped) {
+        diag[0] = 1.0; sup[0] = 0.0; rhs[0] = 0.0;
+        sub[last] = 0.0; diag[last] = 1.0; rhs[last] = 0.0;
+    } else {
+        const double dFirst = (nodes[1].y() - nodes[0].y()) / (nodes[1].x() - nodes[0].x());
+        const double dLast = (nodes[last].y() - nodes[last - 1].y()) / (nodes[last].x() - nodes[last - 1].x());
+        diag[0] = 2.0; sup[0] = 1.0; rhs[0] = 3.0 * dFirst;
+        sub[last] = 1.0; diag[last] = 2.0; rhs[last] = 3.0 * dLast;
+    }
+    // Forward elimination, then back substitution (diagonally dominant, no pivoting)
+    for (int i = 1; i < count; ++i) {
+        const double w = sub[i] / diag[i - 1];
+        diag[i] -= w * sup[i - 1];
+        rhs[i] -= w * rhs[i - 1];
+    }
+    slopes[last] = rhs[last] / diag[last];
+    for (int i = last - 1; i >= 0; --i) slopes[i] = (rhs[i] - sup[i] * slopes[i + 1]) / diag[i];
+}
+
+// One-sided three-point end slope of PCHIP, limited to keep the shape (as in
+// Fritsch & Carlson / MATLAB pchip)
+static double pchipEndSlope(double h0, double h1, double d0, double d1) {
+    double slope = ((2.0 * h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+    if (std::copysign(1.0, slope) != std::copysign(1.0, d0) || d0 == 0.0) {
+        slope = 0.0;
+    } else if (std::copysign(1.0, d0) != std::copysign(1.0, d1) && qAbs(slope) > qAbs(3.0 * d0)) {
+        slope = 3.0 * d0;
+    }
+    return slope;
+}
+
+// Node slopes of the monotone piecewise cubic Hermite interpolant: zero at
+// local extrema, a weighted harmonic mean of the neighbouring secants elsewhere
+static void pchipSlopes(const MotionNode* nodes, int count, double* slopes) {
+    const int segments = count - 1;
+    QVector<double> h(segments), d(segments);
+    for (int i = 0; i < segments; ++i) {
+        h[i] = nodes[i + 1].x() - nodes[i].x();
+        d[i] = (nodes[i + 1].y() - nodes[i].y()) / h[i];
+    }
+    if (count == 2) {
+        slopes[0] = slopes[1] = d[0];
+        return;
+    }
+    for (int i = 1; i < segments; ++i) {
+        if (d[i - 1] * d[i] <= 0.0) {
+            slopes[i] = 0.0;
+        } else {
+            const double w1 = 2.0 * h[i] + h[i - 1];
+            const double w2 = h[i] + 2.0 * h[i - 1];
+            slopes[i] = (w1 + w2) / (w1 / d[i - 1] + w2 / d[i]);
+        }
+    }
+    slopes[0] = pchipEndSlope(h[0], h[1], d[0], d[1]);
+    slopes[segments] = pchipEndSlope(h[segments - 1], h[segments - 2], d[segments - 1], d[segments - 2]);
+}
+
+// Rest-to-rest quintic: y0 + delta * (10 t^3 - 15 t^4 + 6 t^5)
+static SegmentPolynomial sCurveSegment(double y0, double y1, double length) {
+    const double delta = y1 - y0;
+    SegmentPolynomial poly = SegmentPolynomial();
+    poly.c[0] = y0;
+    poly.c[3] = 10.0 * delta;
+    poly.c[4] = -15.0 * delta;
+    poly.c[5] = 6.0 * delta;
+    poly.invLength = 1.0 / length;
+    return poly;
+}
+
+// Zero-length segment: holds the value of its first node
+static SegmentPolynomial holdSegment(double y0) {
+    SegmentPolynomial poly = SegmentPolynomial();
+    poly.c[0] = y0;
+    return poly;
+}
+
+// Fits nodes [first, last] (a run without zero-length segments) into polys[first, last)
+static void fitRun(const QVector<MotionNode>& nodes, int first, int last, InterpolationMode mode,
+                   SegmentPolynomial* polys) {
+    const MotionNode* run = nodes.constData() + first;
+    const int count = last - first + 1;
+    if (mode == InterpolationMode::Linear) {
+        for (int i = 0; i + 1 < count; ++i) {
+            SegmentPolynomial& poly = polys[first + i];
+            poly = SegmentPolynomial();
+            poly.c[0] = run[i].y();
+            poly.c[1] = run[i + 1].y() - run[i].y();
+            poly.invLength = 1.0 / (run[i + 1].x() - run[i].x());
+        }
+        return;
+    }
+    if (mode == InterpolationMode::SCurve) {
+        for (int i = 0; i + 1 < count; ++i) {
+            polys[first + i] = sCurveSegment(run[i].y(), run[i + 1].y(), run[i + 1].x() - run[i].x());
+        }
+        return;
+    }
+
+    QVector<double> slopes(count);
+    if (mode == InterpolationMode::Pchip) {
+        pchipSlopes(run, count, slopes.data());
+    } else {
+        splineSlopes(run, count, mode == InterpolationMode::ClampedCubic, slopes.data());
+    }
+    for (int i = 0; i + 1 < count; ++i) {
+        polys[first + i] = hermiteSegment(run[i].y(), run[i + 1].y(), slopes[i], slopes[i + 1],
+                                          run[i + 1].x() - run[i].x());
+    }
+}
+
+QVector<SegmentPolynomial> buildSegmentPolynomials(const QVector<MotionNode>& nodes, InterpolationMode mode) {
+    const int segmentCount = qMax(0, nodes.size() - 1);
+    QVector<SegmentPolynomial> polys(segmentCount);
+    int runStart = 0;
+    for (int i = 0; i < segmentCount; ++i) {
+        if (nodes[i + 1].x() - nodes[i].x() >= MIN_SEGMENT_LENGTH) continue;
+        // Vertical jump: hold the value, and fit the runs on either side separately
+        if (i > runStart) fitRun(nodes, runStart, i, mode, polys.data());
+        polys[i] = holdSegment(nodes[i].y());
+        runStart = i + 1;
+    }
+    if (segmentCount > runStart) fitRun(nodes, runStart, segmentCount, mode, polys.data());
+    return polys;
+}
+
+// True if segment i exists and is not a zero-length jump (it belongs to a run)
+static bool isRunSegment(const QVector<MotionNode>& nodes, int i) {
+    return i >= 0 && i + 1 < nodes.size() && nodes[i + 1].x() - nodes[i].x() >= MIN_SEGMENT_LENGTH;
+}
+
+// pchipSlopes() for node j alone, from its run neighbours: the same
+// expressions, so the result is identical to a full fit
+static double pchipNodeSlope(const QVector<MotionNode>& nodes, int j) {
+    auto h = [&](int i) { return nodes[i + 1].x() - nodes[i].x(); };
+    auto d = [&](int i) { return (nodes[i + 1].y() - nodes[i].y()) / h(i); };
+    const bool hasLeft = isRunSegment(nodes, j - 1);
+    const bool hasRight = isRunSegment(nodes, j);
+    if (hasLeft && hasRight) {
+        const double d0 = d(j - 1);
+        const double d1 = d(j);
+        if (d0 * d1 <= 0.0) return 0.0;
+        const double w1 = 2.0 * h(j) + h(j - 1);
+        const double w2 = h(j) + 2.0 * h(j - 1);
+        return (w1 + w2) / (w1 / d0 + w2 / d1);
+    }
+    if (hasRight) { // First node of a run
+        if (!isRunSegment(nodes, j + 1)) return d(j);
+        return pchipEndSlope(h(j), h(j + 1), d(j), d(j + 1));
+    }
+    if (hasLeft) { // Last node of a run
+        if (!isRunSegment(nodes, j - 2)) return d(j - 1);
+        return pchipEndSlope(h(j - 1), h(j - 2), d(j - 1), d(j - 2));
+    }
+    return 0.0;
+}
+
+void refitSegmentPolynomials(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                             QVector<SegmentPolynomial>& polys, int firstSegment, int lastSegment) {
+    firstSegment = qMax(firstSegment, 0);
+    lastSegment = qMin(lastSegment, qMin(polys.size(), nodes.size() - 1) - 1);
+    SegmentPolynomial* out = polys.data();
+    double nextSlope = 0.0; // PCHIP: slope of node i, carried over from the previous segment
+    bool haveNextSlope = false;
+    for (int i = firstSegment; i <= lastSegment; ++i) {
+        const MotionNode& a = nodes[i];
+        const MotionNode& b = nodes[i + 1];
+        const double length = b.x() - a.x();
+        if (length < MIN_SEGMENT_LENGTH) {
+            out[i] = holdSegment(a.y());
+            haveNextSlope = false;
+            continue;
+        }
+        if (mode == InterpolationMode::SCurve) {
+            out[i] = sCurveSegment(a.y(), b.y(), length);
+        } else if (mode == InterpolationMode::Pchip) {
+            const double m0 = haveNextSlope ? nextSlope : pchipNodeSlope(nodes, i);
+            nextSlope = pchipNodeSlope(nodes, i + 1);
+            haveNextSlope = true;
+            out[i] = hermiteSegment(a.y(), b.y(), m0, nextSlope, length);
+        } else { // Linear: same table fitRun() builds
+            out[i] = SegmentPolynomial();
+            out[i].c[0] = a.y();
+            out[i].c[1] = b.y() - a.y();
+            out[i].invLength = 1.0 / length;
+        }
+    }
+}
+
+int interpolationReach(InterpolationMode mode) {
+    switch (mode) {
+    case InterpolationMode::Linear:
+    case InterpolationMode::SCurve:
+        return 0; // Segment i only depends on nodes i and i + 1
+    case InterpolationMode::Pchip:
+        return 1; // Node slopes depend on both neighbours
+    case InterpolationMode::NaturalCubic:
+    case InterpolationMode::ClampedCubic:
+        break;
+    }
+    return -1; // A spline couples all nodes of a run
+}
+
+// Scan steps per segment when looking for interior extrema
+static const int PEAK_SCAN_STEPS = 16;
+
+static double polynomialValue(const double* c, int degree, double t) {
+    double value = c[degree];
+    for (int k = degree - 1; k >= 0; --k) value = value * t + c[k];
+    return value;
+}
+
+// Largest |q(t)| for t in [0, 1]. Extrema lie at the ends or where q' changes
+// sign; q' is scanned in PEAK_SCAN_STEPS steps and each sign change bisected.
+static double peakAbs(const double* q, int degree) {
+    double peak = 0.0;
+    for (int s = 0; s <= PEAK_SCAN_STEPS; ++s) {
+        peak = qMax(peak, qAbs(polynomialValue(q, degree, double(s) / PEAK_SCAN_STEPS)));
+    }
+    if (degree < 2) return peak;
+
+    double dq[5];
+    for (int k = 0; k < degree; ++k) dq[k] = (k + 1) * q[k + 1];
+    double t0 = 0.0;
+    double d0 = polynomialValue(dq, degree - 1, t0);
+    for (int s = 1; s <= PEAK_SCAN_STEPS; ++s) {
+        double t1 = double(s) / PEAK_SCAN_STEPS;
+        double d1 = polynomialValue(dq, degree - 1, t1);
+        if ((d0 < 0.0) != (d1 < 0.0)) {
+            double lo = t0, hi = t1, dLo = d0;
+            for (int iteration = 0; iteration < 40; ++iteration) {
+                const double mid = 0.5 * (lo + hi);
+                const double dMid = polynomialValue(dq, degree - 1, mid);
+                if ((dMid < 0.0) == (dLo < 0.0)) { lo = mid; dLo = dMid; } else { hi = mid; }
+            }
+            peak = qMax(peak, qAbs(polynomialValue(q, degree, 0.5 * (lo + hi))));
+        }
+        t0 = t1;
+        d0 = d1;
+    }
+    return peak;
+}
+
+void computeSegmentDerivatives(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                               const QVector<SegmentPolynomial>& polynomials,
+                               int firstSegment, int lastSegment, SegmentDerivatives* out) {
+    const int segmentCount = nodes.size() - 1;
+    firstSegment = qMax(firstSegment, 0);
+    lastSegment = qMin(lastSegment, segmentCount - 1);
+    for (int i = firstSegment; i <= lastSegment; ++i) {
+        SegmentDerivatives& d = out[i];
+        d = SegmentDerivatives();
+        const double length = nodes[i + 1].x() - nodes[i].x();
+        const double delta = nodes[i + 1].y() - nodes[i].y();
+        if (length < MIN_SEGMENT_LENGTH) {
+            if (delta != 0.0) {
+                const double step = std::numeric_limits<double>::infinity();
+                d.velocity = d.acceleration = d.jerk = step;
+            }
+            continue;
+        }
+        if (mode == InterpolationMode::Linear) {
+            d.velocity = qAbs(delta / length);
+            continue;
+        }
+        // Derivatives in normalized time, then scaled by 1 / length per order
+        const SegmentPolynomial& poly = polynomials[i];
+        const double* c = poly.c;
+        const double velocity[5] = { c[1], 2 * c[2], 3 * c[3], 4 * c[4], 5 * c[5] };
+        const double acceleration[4] = { 2 * c[2], 6 * c[3], 12 * c[4], 20 * c[5] };
+        const double jerk[3] = { 6 * c[3], 24 * c[4], 60 * c[5] };
+        const double inv = poly.invLength;
+        d.velocity = peakAbs(velocity, 4) * inv;
+        d.acceleration = peakAbs(acceleration, 3) * inv * inv;
+        d.jerk = peakAbs(jerk, 2) * inv * inv * inv;
+    }
+}
+
+QVector<SegmentDerivatives> buildSegmentDerivatives(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                                                    const QVector<SegmentPolynomial>& polynomials) {
+    QVector<SegmentDerivatives> derivatives(qMax(0, nodes.size() - 1));
+    computeSegmentDerivatives(nodes, mode, polynomials, 0, derivatives.size() - 1, derivatives.data());
+    return derivatives;
+}
+
+int countSlopeViolations(const QVector<SegmentDerivatives>& derivatives, double maxSlope) {
+    if (maxSlope <= 0) return 0;
+    int count = 0;
+    for (const SegmentDerivatives& d : derivatives) {
+        if (d.velocity > maxSlope) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QVector>
+#include "documentdata.h" // MotionNode, InterpolationMode
+
+/**
+ * @brief Polynomial of one segment [x_i, x_i+1] in normalized time.
+ * With t = (time - x_i) * invLength in [0, 1]:
+ *   y(t) = c[0] + c[1] t + c[2] t^2 + c[3] t^3 + c[4] t^4 + c[5] t^5
+ * Cubic modes leave c[4] and c[5] at zero. Zero-length segments (vertical
+ * jumps) have invLength 0 and hold c[0] = y_i, like linear interpolation.
+ * 64 bytes, so one segment is one cache line.
+ */
+struct SegmentPolynomial {
+    double c[6];
+    double invLength;
+    double reserved;
+
+    inline double evaluate(double x0, double time) const {
+        const double t = (time - x0) * invLength;
+        return c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * (c[4] + t * c[5]))));
+    }
+};
+
+/**
+ * @brief Precomputes the segment polynomials of 'nodes' (sorted by X) for a
+ * non-linear mode; O(n). Returns nodes.size() - 1 segments. Runs of nodes
+ * separated by zero-length segments are fitted independently.
+ * Linear needs no table: it is sampled directly from the nodes (see
+ * ProfileSampler), which keeps it bit-exact with earlier versions.
+ */
+QVector<SegmentPolynomial> buildSegmentPolynomials(const QVector<MotionNode>& nodes, InterpolationMode mode);
+
+// Refits polys[firstSegment..lastSegment] (clamped to the valid range) in
+// place, with the same results as buildSegmentPolynomials(). Only for the
+// local modes (interpolationReach() >= 0); 'polys' has one entry per segment.
+void refitSegmentPolynomials(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                             QVector<SegmentPolynomial>& polys, int firstSegment, int lastSegment);
+
+// How far a node's influence reaches: moving node j changes the segment
+// polynomials [j - 1 - reach, j + reach]. -1 means every segment (splines).
+int interpolationReach(InterpolationMode mode);
+
+/**
+ * @brief Peak absolute derivatives of the interpolated curve inside one
+ * segment, in Y units per ms (velocity), per ms^2 (acceleration) and per
+ * ms^3 (jerk). All three come from the same segment polynomial; Linear
+ * segments have a constant velocity, so their acceleration and jerk are 0.
+ * A zero-length segment that changes the value (a vertical jump) is an
+ * instantaneous step and reports infinity; one that does not reports zeros.
+ */
+struct SegmentDerivatives {
+    double velocity = 0.0;
+    double acceleration = 0.0;
+    double jerk = 0.0;
+};
+
+// Computes out[i] for segments [firstSegment, lastSegment]. 'polynomials' must be
+// buildSegmentPolynomials(nodes, mode) (unused, and may be empty, for Linear).
+void computeSegmentDerivatives(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                               const QVector<SegmentPolynomial>& polynomials,
+                               int firstSegment, int lastSegment, SegmentDerivatives* out);
+// All segments at once
+QVector<SegmentDerivatives> buildSegmentDerivatives(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                                                    const QVector<SegmentPolynomial>& polynomials);
+// Segments (including vertical jumps) whose peak velocity exceeds 'maxSlope' (0 = no limit)
+int countSlopeViolations(const QVector<SegmentDerivatives>& derivatives, double maxSlope);
+
+// Stable name used in files and on the command line ("linear", "natural_cubic", ...)
+const char* interpolationModeName(InterpolationMode mode);
+// Name for the UI ("Linear", "Natural Cubic Spline", ...)
+QString interpolationModeLabel(InterpolationMode mode);
+// Parses interpolationModeName(); false for unknown names
+bool parseInterpolationMode(const QString& name, InterpolationMode* mode);
@@ -3,6 +3,12 @@
 #include "grapheditorview.h"
 #include "graphnodeitem.h"
 #include "commands.h"
+#include "sampleexporter.h"
+#include "documentio.h"
+#include "undohistory.h"
+#ifdef MOTION_ENABLE_PROFILING
+#include "performancedock.h"
+#endif
 
 #include <QMenu>
 #include <QMenuBar>
@@ -17,19 +23,24 @@
 #include <QFormLayout>
 #include <QDoubleSpinBox>
 #include <QSpinBox>
+#include <QComboBox>
 #include <QRadioButton>
 #include <QDialogButtonBox>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QStatusBar>
-#include <QUndoStack>
 #include <QDebug>
 #include <QTime>
 #include <QGroupBox>
 #include <QLabel>
 #include <QTextStream>
 #include <QTimer>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <atomic>
+#include <memory>
 #include <QSettings>   // For saving/loading view options
 #include <QFileInfo>   // For getting settings file path
 #include <QDir>        // For getting executable path
@@ -38,7 +49,9 @@
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent), m_selectedNode(nullptr), m_initialViewApplied(false) // Initialize flag
 {
-    m_undoStack = new QUndoStack(this);
+    m_undoStack = new UndoHistory(this);
+    m_undoStack->setCompactor(compactEditCommands); // Old edits become a checkpoint instead of being dropped
+    connect(m_undoStack, &UndoHistory::cleanChanged, this, [this](bool clean) { setWindowModified(!clean); });
     m_document = new MotionDocument(this);
     m_view = new GraphEditorView(this);
     m_view->setDocument(m_document);
@@ -95,7 +108,7 @@ MainWindow::MainWindow(QWidget* parent)
 
     m_undoStack->clear(); // Start with a clean undo stack
     setMinimumSize(800, 600);
-    setWindowTitle("Profile Orchestrator (Qt 5) - YAML");
+    setWindowTitle("Profile Orchestrator (Qt 5) - YAML[*]");
 }
 
 MainWindow::~MainWindow() {
@@ -152,8 +165,8 @@ void MainWindow::createMenus() {
     editMenu->addSeparator();
     editMenu->addAction(m_snapGridAction);
 
-    QMenu* viewMenu = menuBar()->addMenu("View (&V)");
-    viewMenu->addAction(m_fitToViewAction);
+    m_viewMenu = menuBar()->addMenu("View (&V)");
+    m_viewMenu->addAction(m_fitToViewAction);
 }
 
 void MainWindow::createDocks() {
@@ -198,6 +211,12 @@ void MainWindow::createDocks() {
     m_slopeSpin->setRange(0, 100000);
     m_slopeSpin->setValue(1000.0);
     formLayout->addRow("Max Slope:", m_slopeSpin);
+    m_interpolationCombo = new QComboBox;
+    for (int i = 0; i < INTERPOLATION_MODE_COUNT; ++i) {
+        m_interpolationCombo->addItem(interpolationModeLabel(InterpolationMode(i)), i);
+    }
+    m_interpolationCombo->setToolTip("How the curve (and the exported samples) runs between nodes");
+    formLayout->addRow("Interpolation:", m_interpolationCombo);
     m_applyConstraintsButton = new QPushButton("Apply Constraints");
     formLayout->addWidget(m_applyConstraintsButton);
     constraintsGroup->setLayout(formLayout);
@@ -224,6 +243,8 @@ void MainWindow::createDocks() {
     addDockWidget(Qt::RightDockWidgetArea, rightDock);
 
     connect(m_applyConstraintsButton, &QPushButton::clicked, this, &MainWindow::onApplyConstraints);
+    connect(m_interpolationCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
+            this, &MainWindow::onInterpolationModeSelected);
     connect(m_applyNodeCoordsButton, &QPushButton::clicked, this, &MainWindow::onApplyNodeCoords);
 
     // --- Right Dock 2: View Options ---
@@ -275,6 +296,15 @@ void MainWindow::createDocks() {
     // Connect *button* to the new slot
     connect(m_applyViewButton, &QPushButton::clicked, this, &MainWindow::onApplyViewSettings);
     // Remove direct connections from spin boxes
+
+#ifdef MOTION_ENABLE_PROFILING
+    // --- Bottom Dock: Performance (profiling builds only), toggled from the View menu ---
+    PerformanceDock* perfDock = new PerformanceDock(this);
+    addDockWidget(Qt::BottomDockWidgetArea, perfDock);
+    perfDock->hide();
+    m_viewMenu->addSeparator();
+    m_viewMenu->addAction(perfDock->toggleViewAction());
+#endif
 } // End of createDocks
 
 // --- Slot Implementations ---
@@ -341,34 +371,89 @@ void MainWindow::onRemoveMotor() {
 }
 
 void MainWindow::onSaveDocument() {
-    QString fileName = QFileDialog::getSaveFileName(this, "Save Profile", "", "Motion YAML File (*.yaml)");
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Profile", "",
+        "Motion YAML File (*.yaml);;Motion Binary File (*.mpb)");
     if (fileName.isEmpty()) return;
     bool ok;
     QString id = QInputDialog::getText(this, "Enter ID", "Enter File ID:", QLineEdit::Normal, "default_id", &ok);
     if (!ok) return;
     if (id.isEmpty()) id = "default_id";
-    if (!m_document->saveToYAML(fileName, id)) {
+    bool binary = isBinaryDocumentFile(fileName);
+    bool saved = binary ? m_document->saveToBinary(fileName, id) : m_document->saveToYAML(fileName, id);
+    if (!saved) {
         QMessageBox::warning(this, "Save Failed", "Failed to save the file.");
     } else {
-        statusBar()->showMessage("YAML file saved.", 3000);
+        m_undoStack->setClean();
+        statusBar()->showMessage(binary ? "Binary file saved." : "YAML file saved.", 3000);
     }
 }
 
 void MainWindow::onLoadDocument() {
-    QString fileName = QFileDialog::getOpenFileName(this, "Load Profile", "", "Motion YAML File (*.yaml)");
+    QString fileName = QFileDialog::getOpenFileName(this, "Load Profile", "",
+        "Motion Files (*.yaml *.mpb);;Motion YAML File (*.yaml);;Motion Binary File (*.mpb)");
     if (fileName.isEmpty()) return;
 
-    m_undoStack->clear();
+    // Parse on a worker thread; the document is only replaced once the
+    // whole file has been read, so a cancel leaves it untouched
+    bool binary = isBinaryDocumentFile(fileName);
+    QProgressDialog* progress = new QProgressDialog("Loading profile...", "Cancel", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+    auto canceled = std::make_shared<std::atomic_bool>(false);
+    connect(progress, &QProgressDialog::canceled, this, [canceled]() { *canceled = true; });
+    DocumentReadProgress onProgress = [progress, canceled](qint64 done, qint64 total) {
+        // Runs on the load thread: forward to the dialog as a percentage
+        int percent = total > 0 ? int(done * 100 / total) : 100;
+        QMetaObject::invokeMethod(progress, [progress, percent]() { progress->setValue(percent); },
+                                  Qt::QueuedConnection);
+        return !*canceled;
+    };
+
+    QFutureWatcher<DocumentReadResult>* watcher = new QFutureWatcher<DocumentReadResult>(this);
+    m_loadAction->setEnabled(false);
+    connect(watcher, &QFutureWatcher<DocumentReadResult>::finished, this, [=]() {
+        progress->reset();
+        progress->deleteLater();
+        m_loadAction->setEnabled(true);
+        DocumentReadResult result = watcher->result();
+        watcher->deleteLater();
+        switch (result.status) {
+        case DocumentReadStatus::Ok:
+            m_undoStack->clear();
+            m_document->loadData(result.data);
+            statusBar()->showMessage(binary ? "Binary file loaded." : "YAML file loaded.", 3000);
+            QTimer::singleShot(0, this, [=]() {
+                loadViewSettings(); // Load saved settings
+                onApplyViewSettings(); // Apply them
+            });
+            if (!result.warnings.isEmpty()) showLoadWarnings(fileName, result.warnings);
+            break;
+        case DocumentReadStatus::Canceled:
+            statusBar()->showMessage("Loading canceled.", 3000);
+            break;
+        case DocumentReadStatus::Failed:
+            QMessageBox::warning(this, "Load Failed", "Failed to load or parse the file.\n" + result.errorString);
+            break;
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([=]() {
+        return MotionDocument::readFile(fileName, binary, onProgress);
+    }));
+}
 
-    if (!m_document->loadFromYAML(fileName)) {
-        QMessageBox::warning(this, "Load Failed", "Failed to load or parse the file.");
-    } else {
-        statusBar()->showMessage("YAML file loaded.", 3000);
-         QTimer::singleShot(0, this, [=]() {
-             loadViewSettings(); // Load saved settings
-             onApplyViewSettings(); // Apply them
-         });
+// The first issues go in the details, so a badly broken file stays readable
+void MainWindow::showLoadWarnings(const QString& fileName, const QStringList& warnings) {
+    const int MAX_LISTED_WARNINGS = 100;
+    QStringList listed = warnings.mid(0, MAX_LISTED_WARNINGS);
+    if (warnings.size() > MAX_LISTED_WARNINGS) {
+        listed.append(QString("... and %1 more").arg(warnings.size() - MAX_LISTED_WARNINGS));
     }
+    QMessageBox box(QMessageBox::Warning, "Load Warnings",
+                    QString("%1 was loaded, but %2 problem(s) were found. The affected lines or nodes were skipped.")
+                        .arg(QFileInfo(fileName).fileName()).arg(warnings.size()),
+                    QMessageBox::Ok, this);
+    box.setDetailedText(listed.join('\n'));
+    box.exec();
 }
 
 void MainWindow::onFitToView() {
@@ -382,6 +467,23 @@ void MainWindow::onApplyConstraints() {
     }
 }
 
+void MainWindow::onInterpolationModeSelected(int comboIndex) {
+    MotorProfile* profile = m_document ? m_document->activeProfile() : nullptr;
+    if (!profile || comboIndex < 0 || !m_undoStack) return;
+    InterpolationMode mode = InterpolationMode(m_interpolationCombo->itemData(comboIndex).toInt());
+    if (mode == profile->interpolationMode()) return;
+    m_undoStack->push(new SetInterpolationModeCommand(profile, mode));
+}
+
+// The mode can also change through undo/redo: keep the combo in sync
+void MainWindow::onActiveInterpolationChanged() {
+    MotorProfile* profile = m_document ? m_document->activeProfile() : nullptr;
+    if (!profile) return;
+    m_interpolationCombo->blockSignals(true);
+    m_interpolationCombo->setCurrentIndex(m_interpolationCombo->findData(int(profile->interpolationMode())));
+    m_interpolationCombo->blockSignals(false);
+}
+
 void MainWindow::onDocumentModelChanged() {
     m_motorTreeWidget->blockSignals(true);
     m_motorTreeWidget->clear();
@@ -423,6 +525,7 @@ void MainWindow::onActiveMotorSwitched(MotorProfile* active, MotorProfile* previ
     m_yMinSpin->setEnabled(motorIsActive);
     m_yMaxSpin->setEnabled(motorIsActive);
     m_slopeSpin->setEnabled(motorIsActive);
+    m_interpolationCombo->setEnabled(motorIsActive);
     m_applyConstraintsButton->setEnabled(motorIsActive);
 
     if (active) {
@@ -463,6 +566,10 @@ void MainWindow::connectProfileToSpinBoxes(MotorProfile* profile) {
     m_yMinSpin->setValue(profile->yMin());
     m_yMaxSpin->setValue(profile->yMax());
     m_slopeSpin->setValue(profile->maxSlope());
+    m_interpolationCombo->blockSignals(true);
+    m_interpolationCombo->setCurrentIndex(m_interpolationCombo->findData(int(profile->interpolationMode())));
+    m_interpolationCombo->blockSignals(false);
+    connect(profile, &MotorProfile::interpolationChanged, this, &MainWindow::onActiveInterpolationChanged, Qt::UniqueConnection);
 
     m_yMinSpin->blockSignals(false);
     m_yMaxSpin->blockSignals(false);
@@ -481,6 +588,7 @@ void MainWindow::connectProfileToSpinBoxes(MotorProfile* profile) {
 
 void MainWindow::disconnectProfileFromSpinBoxes(MotorProfile* profile) {
      if (!profile) return;
+     disconnect(profile, &MotorProfile::interpolationChanged, this, &MainWindow::onActiveInterpolationChanged);
      #if QT_VERSION >= QT_VERSION_CHECK(5, 7, 0)
          disconnect(m_yMinSpin, qOverload<double>(&QDoubleSpinBox::valueChanged), profile, &MotorProfile::setYMin);
          disconnect(m_yMaxSpin, qOverload<double>(&QDoubleSpinBox::valueChanged), profile, &MotorProfile::setYMax);
@@ -493,33 +601,6 @@ void MainWindow::disconnectProfileFromSpinBoxes(MotorProfile* profile) {
 }
 
 
-void MainWindow::writeYAMLSamples(QTextStream& out, MotorProfile* profile, double sampleRateHz, double endTimeSec) const {
-    if (!profile) return;
-    QString keyName = profile->name(); keyName.replace(':', '_').replace(' ', '_');
-    out << "  " << keyName << ":\n";
-    out << "    - [";
-    if (sampleRateHz <= 0 || endTimeSec < 0) {
-        out << "]\n";
-        return;
-    }
-    double dt_ms = (1.0 / sampleRateHz) * 1000.0;
-    if (dt_ms < 1e-3) dt_ms = 1.0;
-    bool first = true;
-    for (double time_ms = 0.0; time_ms <= endTimeSec + (dt_ms/2.0); time_ms += dt_ms) {
-         double capped_time_ms = qMin(time_ms, endTimeSec);
-        if (!first) out << ", ";
-        double value = profile->sampleAt(capped_time_ms);
-        out << "[" << QString::number(capped_time_ms, 'g', 10) << ", " << QString::number(value, 'g', 10) << "]";
-        first = false;
-         if (capped_time_ms >= endTimeSec) break;
-    }
-     if (endTimeSec == 0.0 && dt_ms > 0.0 && first) {
-         double value = profile->sampleAt(0.0);
-         out << "[" << QString::number(0.0, 'g', 10) << ", " << QString::number(value, 'g', 10) << "]";
-     }
-    out << "]\n";
-}
-
 void MainWindow::onExportDocument() {
     if (!m_document) return;
     QDialog dialog(this);
@@ -527,19 +608,28 @@ void MainWindow::onExportDocument() {
     QVBoxLayout layout(&dialog);
     QLabel* infoLabel = new QLabel("Export all motors as a sampled YAML file.");
     layout.addWidget(infoLabel);
+    // Constraint check from the profiles' cached segment derivatives
+    QStringList slopeWarnings;
+    for (MotorProfile* profile : m_document->motorProfiles()) {
+        int violations = profile->slopeViolationCount();
+        if (violations > 0) {
+            slopeWarnings.append(QString("%1: %2 segment(s) above max slope %3")
+                .arg(profile->name()).arg(violations).arg(profile->maxSlope()));
+        }
+    }
+    if (!slopeWarnings.isEmpty()) {
+        QLabel* slopeLabel = new QLabel("Warning, max slope exceeded:\n" + slopeWarnings.join("\n"));
+        layout.addWidget(slopeLabel);
+    }
     QWidget* optionsWidget = new QWidget;
     QFormLayout* optionsLayout = new QFormLayout(optionsWidget);
     QDoubleSpinBox* endTimeSpin = new QDoubleSpinBox;
     endTimeSpin->setRange(0.0, 1000000.0);
     endTimeSpin->setDecimals(0);
     endTimeSpin->setSingleStep(100);
-    double maxTime = 2000.0;
-    for (MotorProfile* p : m_document->motorProfiles()) {
-        if (p && !p->nodes().isEmpty() && p->nodes().last().x() > maxTime) {
-            maxTime = p->nodes().last().x();
-        }
-    }
-    endTimeSpin->setValue(maxTime);
+    // Snapshot the motors now; the export streams from this copy
+    QVector<SampleExportMotor> motors = collectExportMotors(m_document->toData(QString()));
+    endTimeSpin->setValue(defaultExportEndTime(motors));
     endTimeSpin->setSuffix(" ms");
     QSpinBox* hzSpin = new QSpinBox;
     hzSpin->setRange(1, 10000);
@@ -560,23 +650,52 @@ void MainWindow::onExportDocument() {
     if (id.isEmpty()) id = "default_id";
     QString fileName = QFileDialog::getSaveFileName(this, "Export Samples", "", "YAML File (*.yaml)");
     if (fileName.isEmpty()) return;
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "File Error", "Could not open file for writing:\n" + file.errorString());
-        return;
-    }
-    QTextStream out(&file);
-    out.setCodec("UTF-8");
-    out << "id: " << id << "\n";
-    double endTimeMs = endTimeSpin->value();
-    int sampleRateHz = hzSpin->value();
-    for (MotorProfile* profile : m_document->motorProfiles()) {
-         if (profile) {
-             writeYAMLSamples(out, profile, sampleRateHz, endTimeMs);
-         }
-    }
-    file.close();
-    statusBar()->showMessage("Sample export complete.", 3000);
+
+    // Stream the export from a worker thread
+    SampleExportSettings settings;
+    settings.endTimeMs = endTimeSpin->value();
+    settings.sampleRateHz = hzSpin->value();
+
+    QProgressDialog* progress = new QProgressDialog("Exporting samples...", "Cancel", 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    auto canceled = std::make_shared<std::atomic_bool>(false);
+    connect(progress, &QProgressDialog::canceled, this, [canceled]() { *canceled = true; });
+    SampleExportProgress onProgress = [progress, canceled](int done, int total) {
+        // Runs on the export thread: forward to the dialog on the GUI thread
+        QMetaObject::invokeMethod(progress, [progress, done, total]() {
+            progress->setMaximum(total);
+            progress->setValue(done);
+        }, Qt::QueuedConnection);
+        return !*canceled;
+    };
+
+    QFutureWatcher<SampleExportResult>* watcher = new QFutureWatcher<SampleExportResult>(this);
+    m_exportAction->setEnabled(false);
+    connect(watcher, &QFutureWatcher<SampleExportResult>::finished, this, [=]() {
+        progress->reset();
+        progress->deleteLater();
+        m_exportAction->setEnabled(true);
+        SampleExportResult result = watcher->result();
+        watcher->deleteLater();
+        switch (result.status) {
+        case SampleExportStatus::Ok:
+            statusBar()->showMessage("Sample export complete.", 3000);
+            break;
+        case SampleExportStatus::Canceled:
+            statusBar()->showMessage("Sample export canceled.", 3000);
+            break;
+        case SampleExportStatus::OpenFailed:
+            QMessageBox::warning(this, "File Error", "Could not open file for writing:\n" + result.errorString);
+            break;
+        case SampleExportStatus::WriteFailed:
+            QMessageBox::warning(this, "File Error", "Could not write the export file:\n" + result.errorString);
+            break;
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([=]() {
+        return exportSamplesToFile(fileName, id, motors, settings, onProgress);
+    }));
 }
 
 void MainWindow::onNodeSelected(QGraphicsItem* selectedNodeItem) {
@@ -639,6 +758,10 @@ void MainWindow::saveViewSettings() {
     // XMin/XMax Removed
     settings.setValue("SnapGrid", m_snapGridAction->isChecked());
     settings.endGroup();
+
+    settings.beginGroup("Undo");
+    settings.setValue("MemoryBudgetMB", m_undoStack->memoryBudget() / (1024 * 1024));
+    settings.endGroup();
 }
 
 void MainWindow::loadViewSettings() {
@@ -656,6 +779,11 @@ void MainWindow::loadViewSettings() {
     m_snapGridAction->setChecked(settings.value("SnapGrid", false).toBool());
     settings.endGroup();
 
+    settings.beginGroup("Undo");
+    qint64 budgetMB = settings.value("MemoryBudgetMB", DEFAULT_UNDO_MEMORY_BUDGET / (1024 * 1024)).toLongLong();
+    m_undoStack->setMemoryBudget(qMax<qint64>(1, budgetMB) * 1024 * 1024);
+    settings.endGroup();
+
     // Apply loaded settings to the view's internal state
     if(m_view) {
         m_view->setNumYDivisions(m_yDivisionsSpin->value());
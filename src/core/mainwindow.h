@@ -18,13 +18,14 @@ class QTreeWidget;
 class QTreeWidgetItem;
 class QDoubleSpinBox;
 class QSpinBox;
+class QComboBox;
 class QToolButton;
 class QPushButton;
-class QUndoStack;
+class UndoHistory;
 class QAction;
+class QMenu;
 class QGroupBox;
 class QDockWidget;
-class QTextStream;
 class QSettings; // For settings
 
 /**
@@ -60,6 +61,8 @@ private slots:
 
     // Properties actions
     void onApplyConstraints(); // Applies Y Min/Max from profile
+    void onInterpolationModeSelected(int comboIndex); // Sets the active motor's mode (undoable)
+    void onActiveInterpolationChanged(); // Syncs the combo with the active motor's mode
 
     // Model update slots
     void onDocumentModelChanged(); // Rebuilds motor list
@@ -83,16 +86,14 @@ private:
     QString getSettingsFilePath() const;
     void connectProfileToSpinBoxes(MotorProfile* profile);
     void disconnectProfileFromSpinBoxes(MotorProfile* profile);
-
-    // YAML export helpers
-    void writeYAMLSamples(QTextStream& out, MotorProfile* profile, double sampleRateHz, double endTimeSec) const;
+    void showLoadWarnings(const QString& fileName, const QStringList& warnings); // Skipped YAML lines after a load
 
     // Core data and view
     MotionDocument* m_document;
     GraphEditorView* m_view;
 
-    // Undo/Redo stack
-    QUndoStack* m_undoStack;
+    // Undo/Redo stack (memory-budgeted, see undohistory.h)
+    UndoHistory* m_undoStack;
 
     // Left Dock: Motor List
     QTreeWidget* m_motorTreeWidget;
@@ -103,6 +104,7 @@ private:
     QDoubleSpinBox* m_yMaxSpin;
     QDoubleSpinBox* m_yMinSpin;
     QDoubleSpinBox* m_slopeSpin;
+    QComboBox* m_interpolationCombo;
     QPushButton* m_applyConstraintsButton;
 
     // Right Dock 1: Selected Node Editor
@@ -128,6 +130,7 @@ private:
     QAction* m_redoAction;
     QAction* m_fitToViewAction;
     QAction* m_snapGridAction;
+    QMenu* m_viewMenu;
 
     // Flag for initial view setup
     bool m_initialViewApplied = false;
@@ -1,11 +1,13 @@
 #include "motionmodels.h"
+#include "profilesampler.h"
+#include "yamlwriter.h"
+#include "binaryformat.h"
+#include "perftrace.h"
 #include <QFile>
-#include <QTextStream>
 #include <QDebug>
-#include <algorithm> // for std::sort
+#include <QRandomGenerator>
+#include <algorithm> // std::upper_bound, std::rotate, std::is_sorted
 #include <qmath.h>   // qBound, qAbs, fmod, qFloor, qMax
-#include <QStringList> // For YAML parsing
-#include <limits> // For std::numeric_limits
 
 // --- MotorProfile Implementation ---
 MotorProfile::MotorProfile(const QString& name, QColor color, QObject* parent)
@@ -49,11 +51,13 @@ void MotorProfile::checkAllNodes() {
         double oldY = node.y();
         double clampedY = qBound(m_y_min, oldY, m_y_max);
         if (qAbs(oldY - clampedY) > 1e-6) {
+            recordBatchChange(m_nodeIds[i], true, node);
             node.setY(clampedY);
             dataWasChanged = true;
         }
     }
-    if (dataWasChanged) {
+    if (dataWasChanged) invalidateInterpolation();
+    if (dataWasChanged && !deferNotification()) {
         emit dataChanged();
     }
 }
@@ -63,17 +67,113 @@ double MotorProfile::sampleAt(double time) const {
     if (time <= m_nodes.first().x()) return m_nodes.first().y();
     if (time >= m_nodes.last().x()) return m_nodes.last().y();
 
-    for (int i = 0; i < m_nodes.size() - 1; ++i) {
-        const MotionNode& prev = m_nodes[i];
-        const MotionNode& next = m_nodes[i+1];
-        if (prev.x() <= time && next.x() >= time) {
-            if (qAbs(next.x() - prev.x()) < 1e-6) return prev.y();
-            double t = (time - prev.x()) / (next.x() - prev.x());
-            return prev.y() * (1.0 - t) + next.y() * t;
-        }
+    // Nodes are kept sorted by X, so the segment is found by binary search
+    int segment = ProfileSampler::findSegment(m_nodes, time);
+    if (m_interpolation != InterpolationMode::Linear) {
+        return segmentPolynomials()[segment].evaluate(m_nodes[segment].x(), time);
     }
-    qWarning() << "sampleAt: Time" << time << "was within bounds but segment not found.";
-    return m_nodes.last().y();
+    return ProfileSampler::interpolate(m_nodes[segment], m_nodes[segment + 1], time);
+}
+
+void MotorProfile::sampleRange(double t0, double dt, int count, double* out) const {
+    sampler().sampleRange(t0, dt, count, out);
+}
+
+// Segments [*first, *last] of a per-segment cache that need recomputing
+// (none when first > last). Everything when 'dirty' says so, the size is
+// stale, or any segment changed and the reach is global (splines); otherwise
+// the dirty range widened by 'reach'. Returns true for a full rebuild and
+// clears 'dirty'.
+static bool staleSegments(SegmentDirtyRange& dirty, int cacheSize, int segmentCount, int reach,
+                          int* first, int* last) {
+    const bool changed = dirty.first <= dirty.last;
+    const bool all = dirty.all || cacheSize != segmentCount || (changed && reach < 0);
+    *first = 0;
+    *last = -1;
+    if (all) {
+        *last = segmentCount - 1;
+    } else if (changed) {
+        *first = qMax(0, dirty.first - reach);
+        *last = qMin(segmentCount - 1, dirty.last + reach);
+    }
+    dirty.clear();
+    return all;
+}
+
+const QVector<SegmentPolynomial>& MotorProfile::segmentPolynomials() const {
+    if (m_interpolation == InterpolationMode::Linear) {
+        m_polynomials.clear();
+        m_polynomialsDirty.all = true;
+        return m_polynomials;
+    }
+    const int segmentCount = qMax(0, m_nodes.size() - 1);
+    int first, last;
+    if (staleSegments(m_polynomialsDirty, m_polynomials.size(), segmentCount,
+                      interpolationReach(m_interpolation), &first, &last)) {
+        m_polynomials = buildSegmentPolynomials(m_nodes, m_interpolation);
+    } else if (first <= last) {
+        PERF_COUNT("refitted segments", last - first + 1);
+        refitSegmentPolynomials(m_nodes, m_interpolation, m_polynomials, first, last);
+    }
+    return m_polynomials;
+}
+
+ProfileSampler MotorProfile::sampler() const {
+    return ProfileSampler(m_nodes, m_interpolation, segmentPolynomials());
+}
+
+const QVector<SegmentDerivatives>& MotorProfile::segmentDerivatives() const {
+    const int segmentCount = qMax(0, m_nodes.size() - 1);
+    int first, last;
+    if (staleSegments(m_derivativesDirty, m_derivatives.size(), segmentCount,
+                      interpolationReach(m_interpolation), &first, &last)) {
+        m_derivatives.resize(segmentCount);
+    }
+    if (first <= last) {
+        PERF_COUNT("derivative segments", last - first + 1);
+        computeSegmentDerivatives(m_nodes, m_interpolation, segmentPolynomials(), first, last, m_derivatives.data());
+    }
+    return m_derivatives;
+}
+
+void MotorProfile::invalidateNodes(int first, int last) {
+    // Segment i runs from node i to node i + 1
+    m_polynomialsDirty.mark(first - 1, last);
+    m_derivativesDirty.mark(first - 1, last);
+}
+
+// Inserts or removes one cache entry at 'segment' while the cache is still
+// incrementally maintained (a stale size forces a full rebuild anyway)
+template <typename T>
+static void insertCachedSegment(QVector<T>& cache, SegmentDirtyRange& dirty, int segment) {
+    if (dirty.all) return;
+    cache.insert(qBound(0, segment, cache.size()), T());
+    dirty.segmentInserted(segment);
+}
+
+template <typename T>
+static void removeCachedSegment(QVector<T>& cache, SegmentDirtyRange& dirty, int segment) {
+    if (dirty.all) return;
+    if (cache.isEmpty()) { dirty.all = true; return; }
+    cache.remove(qBound(0, segment, cache.size() - 1));
+    dirty.segmentRemoved(segment);
+}
+
+void MotorProfile::cachedSegmentInserted(int segment) {
+    insertCachedSegment(m_polynomials, m_polynomialsDirty, segment);
+    insertCachedSegment(m_derivatives, m_derivativesDirty, segment);
+}
+
+void MotorProfile::cachedSegmentRemoved(int segment) {
+    removeCachedSegment(m_polynomials, m_polynomialsDirty, segment);
+    removeCachedSegment(m_derivatives, m_derivativesDirty, segment);
+}
+
+void MotorProfile::setInterpolationMode(InterpolationMode mode) {
+    if (m_interpolation == mode) return;
+    m_interpolation = mode;
+    invalidateInterpolation();
+    emit interpolationChanged();
 }
 
 bool MotorProfile::isNodeValid(const MotionNode& node, int /*indexToIgnore*/) const {
@@ -84,37 +184,170 @@ bool MotorProfile::isNodeValid(const MotionNode& node, int /*indexToIgnore*/) co
     return true;
 }
 
+// --- Node identities ---
+quint32 MotorProfile::nodeId(int index) const {
+    return (index >= 0 && index < m_nodeIds.size()) ? m_nodeIds[index] : 0;
+}
+
+int MotorProfile::indexOfNode(quint32 id) const {
+    return m_idToIndex.value(id, -1);
+}
+
+void MotorProfile::reindexNodeIds(int first, int last) {
+    for (int i = first; i <= last; ++i) {
+        m_idToIndex[m_nodeIds[i]] = i;
+    }
+}
+
+void MotorProfile::setNodes(const QVector<MotionNode>& nodes) {
+    if (m_batchDepth > 0) {
+        for (int i = 0; i < m_nodes.size(); ++i) recordBatchChange(m_nodeIds[i], true, m_nodes[i]);
+    }
+    m_nodes = nodes; // Implicitly shared until modified
+    if (!std::is_sorted(m_nodes.constBegin(), m_nodes.constEnd(), motionNodeLess)) {
+        sortMotionNodes(m_nodes);
+    }
+    invalidateInterpolation();
+    m_nodeIds.resize(m_nodes.size());
+    m_idToIndex.clear();
+    m_idToIndex.reserve(m_nodes.size());
+    for (int i = 0; i < m_nodes.size(); ++i) {
+        m_nodeIds[i] = m_nextNodeId++;
+        m_idToIndex.insert(m_nodeIds[i], i);
+        recordBatchChange(m_nodeIds[i], false);
+    }
+    if (!deferNotification()) emit dataChanged();
+}
+
+void MotorProfile::restoreSnapshot(const NodeSnapshot& snapshot) {
+    if (m_batchDepth > 0) {
+        for (int i = 0; i < m_nodes.size(); ++i) recordBatchChange(m_nodeIds[i], true, m_nodes[i]);
+        for (quint32 id : snapshot.ids) recordBatchChange(id, false); // No-op for IDs that existed
+    }
+    m_nodes = snapshot.nodes;
+    m_nodeIds = snapshot.ids;
+    invalidateInterpolation();
+    m_idToIndex.clear();
+    m_idToIndex.reserve(m_nodeIds.size());
+    for (int i = 0; i < m_nodeIds.size(); ++i) {
+        m_idToIndex.insert(m_nodeIds[i], i);
+        m_nextNodeId = qMax(m_nextNodeId, m_nodeIds[i] + 1);
+    }
+    if (!deferNotification()) emit dataChanged();
+}
+
+// --- Batch editing ---
+void MotorProfile::beginBatch() {
+    if (m_batchDepth++ == 0) {
+        m_batchChanged = false;
+        m_batchChanges.clear();
+        m_batchChangeIndex.clear();
+    }
+}
+
+QVector<NodeChange> MotorProfile::commitBatch() {
+    QVector<NodeChange> changes;
+    if (m_batchDepth == 0) {
+        qWarning() << "commitBatch: No batch in progress";
+        return changes;
+    }
+    if (--m_batchDepth > 0) return changes;
+
+    // Fill in the final state of each touched node; drop the ones that
+    // ended up where they started (or were added and removed again)
+    changes.reserve(m_batchChanges.size());
+    for (NodeChange change : qAsConst(m_batchChanges)) {
+        int index = indexOfNode(change.id);
+        change.existsAfter = index >= 0;
+        if (change.existsAfter) change.after = m_nodes[index];
+        if (!change.isNoOp()) changes.append(change);
+    }
+    m_batchChanges.clear();
+    m_batchChangeIndex.clear();
+    if (m_batchChanged) {
+        m_batchChanged = false;
+        emit dataChanged();
+    }
+    return changes;
+}
+
+bool MotorProfile::deferNotification() {
+    if (m_batchDepth == 0) return false;
+    m_batchChanged = true;
+    return true;
+}
+
+void MotorProfile::recordBatchChange(quint32 id, bool existed, const MotionNode& pos) {
+    if (m_batchDepth == 0 || m_batchChangeIndex.contains(id)) return;
+    NodeChange change;
+    change.id = id;
+    change.existedBefore = existed;
+    change.before = pos;
+    m_batchChangeIndex.insert(id, m_batchChanges.size());
+    m_batchChanges.append(change);
+}
+
 // --- Internal functions for Undo/Redo ---
-int MotorProfile::internalAddNode(const MotionNode& node) {
-    m_nodes.append(node);
-    sortNodes();
-    emitDataChanged(); // Emit signal
-    return m_nodes.indexOf(node);
+// Index after the last node that does not sort after 'node' (sorted insert position)
+static int upperBoundIndex(const QVector<MotionNode>& nodes, const MotionNode& node) {
+    return int(std::upper_bound(nodes.constBegin(), nodes.constEnd(), node, motionNodeLess) - nodes.constBegin());
+}
+
+int MotorProfile::internalAddNode(const MotionNode& node, quint32 id) {
+    if (id == 0 || m_idToIndex.contains(id)) id = m_nextNodeId++;
+    recordBatchChange(id, false);
+    int index = upperBoundIndex(m_nodes, node);
+    m_nodes.insert(index, node);
+    m_nodeIds.insert(index, id);
+    // The segment through the new node's position is split in two
+    cachedSegmentInserted(qMax(0, index - 1));
+    invalidateNodes(index, index);
+    reindexNodeIds(index, m_nodes.size() - 1);
+    if (!deferNotification()) emit nodeInserted(index);
+    return index;
 }
 
 void MotorProfile::internalRemoveNode(int index) {
     if (index >= 0 && index < m_nodes.size()) {
+        recordBatchChange(m_nodeIds[index], true, m_nodes[index]);
+        m_idToIndex.remove(m_nodeIds[index]);
         m_nodes.remove(index);
-        emitDataChanged(); // Emit signal
+        m_nodeIds.remove(index);
+        // The two segments around the node merge into one
+        cachedSegmentRemoved(index);
+        invalidateNodes(index - 1, index);
+        reindexNodeIds(index, m_nodes.size() - 1);
+        if (!deferNotification()) emit nodeRemoved(index);
     } else {
          qWarning() << "internalRemoveNode: Invalid index" << index;
     }
 }
 
-void MotorProfile::internalMoveNode(int index, const MotionNode& pos) {
-    if (index >= 0 && index < m_nodes.size()) {
-        m_nodes[index] = pos;
-        // Sorting and signal emit handled by MoveNodeCommand(s)
-    } else {
+int MotorProfile::internalMoveNode(int index, const MotionNode& pos) {
+    if (index < 0 || index >= m_nodes.size()) {
         qWarning() << "internalMoveNode: Invalid index" << index;
+        return -1;
     }
-}
-
-void MotorProfile::sortNodes() {
-    std::sort(m_nodes.begin(), m_nodes.end(), [](const MotionNode& a, const MotionNode& b) {
-        if (qAbs(a.x() - b.x()) < 1e-9) return a.y() < b.y();
-        return a.x() < b.x();
-    });
+    // Local re-sort: the rest of the vector is still sorted, so the node is
+    // bubbled into place on the side it moved to (binary search + rotate)
+    recordBatchChange(m_nodeIds[index], true, m_nodes[index]);
+    m_nodes[index] = pos;
+    int newIndex = index;
+    auto nodes = m_nodes.begin();
+    auto ids = m_nodeIds.begin();
+    if (index > 0 && motionNodeLess(pos, m_nodes[index - 1])) {
+        newIndex = int(std::upper_bound(nodes, nodes + index, pos, motionNodeLess) - nodes);
+        std::rotate(nodes + newIndex, nodes + index, nodes + index + 1);
+        std::rotate(ids + newIndex, ids + index, ids + index + 1);
+    } else if (index + 1 < m_nodes.size() && motionNodeLess(m_nodes[index + 1], pos)) {
+        newIndex = int(std::upper_bound(nodes + index + 1, m_nodes.end(), pos, motionNodeLess) - nodes) - 1;
+        std::rotate(nodes + index, nodes + index + 1, nodes + newIndex + 1);
+        std::rotate(ids + index, ids + index + 1, ids + newIndex + 1);
+    }
+    invalidateNodes(qMin(index, newIndex), qMax(index, newIndex));
+    reindexNodeIds(qMin(index, newIndex), qMax(index, newIndex));
+    if (!deferNotification()) emit nodeMoved(index, newIndex);
+    return newIndex;
 }
 
 void MotorProfile::emitDataChanged() {
@@ -178,141 +411,119 @@ void MotionDocument::removeMotor(MotorProfile* profile) {
 
 // Save all motors to YAML format
 bool MotionDocument::saveToYAML(const QString& filename, const QString& id) const {
+    PERF_SCOPE("MotionDocument::saveToYAML");
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         qWarning() << "Failed to open file for writing:" << filename << file.errorString();
         return false;
     }
-    QTextStream out(&file);
-    out.setCodec("UTF-8");
+    YamlWriter out(&file);
 
-    out << "id: " << id << "\n";
+    out.write("id: ").write(id).write("\n");
     for (const MotorProfile* profile : m_profiles) {
         if (!profile) continue;
         QString keyName = profile->name();
         keyName.replace(':', '_').replace(' ', '_');
         if (keyName.isEmpty()) keyName = "unnamed_motor";
 
-        out << keyName << ":\n";
-        out << "  - [";
+        out.write(keyName).write(":\n");
+        if (profile->interpolationMode() != InterpolationMode::Linear) {
+            // Optional line; linear profiles are written exactly as before
+            out.write("  interpolation: ").write(interpolationModeName(profile->interpolationMode())).write("\n");
+        }
+        out.write("  - [");
         bool firstNode = true;
         for (const MotionNode& node : profile->nodes()) {
-            if (!firstNode) out << ", ";
-            out << "[" << QString::number(node.x(), 'g', 10) << ", "
-                << QString::number(node.y(), 'g', 10) << "]";
+            if (!firstNode) out.write(", ");
+            out.write("[").writeNumber(node.x()).write(", ").writeNumber(node.y()).write("]");
             firstNode = false;
         }
-        out << "]\n";
+        out.write("]\n");
     }
+    bool ok = out.flush();
     file.close();
-    return true;
+    if (!ok) qWarning() << "Failed to write file:" << filename << file.errorString();
+    return ok;
 }
 
 // Load motors from YAML format
 bool MotionDocument::loadFromYAML(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open file for reading:" << filename << file.errorString();
-        return false;
+    DocumentReadResult result = readFile(filename, false);
+    if (result.status != DocumentReadStatus::Ok) return false;
+    loadData(result.data);
+    return true;
+}
+
+DocumentReadResult MotionDocument::readFile(const QString& filename, bool binary,
+                                            const DocumentReadProgress& progress) {
+    DocumentReadResult result = readDocumentFile(filename, binary, progress);
+    if (!binary && result.status == DocumentReadStatus::Ok) {
+        for (MotorData& motor : result.data.motors) {
+            motor.color = QColor::fromHsv(QRandomGenerator::global()->bounded(360), 200, 200).rgba();
+        }
     }
-    QTextStream in(&file);
-    in.setCodec("UTF-8");
+    return result;
+}
 
+MotionDocumentData MotionDocument::toData(const QString& id) const {
+    MotionDocumentData data;
+    data.id = id;
+    for (const MotorProfile* profile : m_profiles) {
+        if (!profile) continue;
+        MotorData motor;
+        motor.name = profile->name();
+        motor.color = profile->color().rgba();
+        motor.yMin = profile->yMin();
+        motor.yMax = profile->yMax();
+        motor.maxSlope = profile->maxSlope();
+        motor.interpolation = profile->interpolationMode();
+        motor.nodes = profile->nodes(); // Implicitly shared, no copy
+        data.motors.append(motor);
+    }
+    return data;
+}
+
+void MotionDocument::loadData(const MotionDocumentData& data) {
+    PERF_SCOPE("MotionDocument::loadData");
     emit documentCleared();
     qDeleteAll(m_profiles);
     m_profiles.clear();
     m_activeProfile = nullptr;
 
-    QString file_id;
-    MotorProfile* currentProfile = nullptr;
-    bool dataChangedInProfile = false;
-    // <<< 변수 추가: Y Min/Max 추적 >>>
-    double profileMinY = std::numeric_limits<double>::max();
-    double profileMaxY = -std::numeric_limits<double>::max();
-    bool nodesFound = false;
-
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty() || line.startsWith('#')) continue;
-
-        if (line.startsWith("id:")) {
-            file_id = line.mid(3).trimmed();
-        }
-        else if (!line.startsWith(" ") && line.endsWith(":")) { // Motor definition
-            // If data changed in previous profile, sort and emit signal
-            if (currentProfile && dataChangedInProfile) {
-                currentProfile->sortNodes();
-                // <<< 로직 추가: Y Min/Max 설정 >>>
-                if (nodesFound) {
-                    currentProfile->setYMin(profileMinY);
-                    currentProfile->setYMax(profileMaxY);
-                } // (else: use defaults -100/100)
-                currentProfile->emitDataChanged(); // Emit signal *after* setting constraints
-                dataChangedInProfile = false;
-            }
-            QString name = line.left(line.length() - 1).trimmed();
-            QColor color = QColor::fromHsv(qrand() % 360, 200, 200);
-            currentProfile = addMotor(name, color);
-            // <<< 변수 리셋 >>>
-            nodesFound = false;
-            profileMinY = std::numeric_limits<double>::max();
-            profileMaxY = -std::numeric_limits<double>::max();
-            if (!currentProfile) qWarning() << "Failed to create motor:" << name;
-        }
-        else if (line.startsWith("- [") && line.endsWith("]") && currentProfile) { // Node list
-            QString nodes_str = line.mid(3, line.length() - 4).trimmed();
-            nodes_str.remove(' ');
-
-            if (nodes_str.isEmpty()) {
-                currentProfile->emitDataChanged(); // Emit for empty node list
-                continue;
-            }
-
-            QStringList node_pairs = nodes_str.split("],[", QString::SkipEmptyParts);
-            for (const QString& pair : node_pairs) {
-                QString cleaned_pair = pair;
-                if (cleaned_pair.startsWith('[')) cleaned_pair.remove(0, 1);
-                if (cleaned_pair.endsWith(']')) cleaned_pair.chop(1);
-                QStringList values = cleaned_pair.split(',');
-
-                if (values.size() == 2) {
-                    bool okX, okY;
-                    double time = values[0].toDouble(&okX);
-                    double value = values[1].toDouble(&okY);
-                    if (okX && okY) {
-                        // <<< 수정: Non-const getter 사용 >>>
-                        currentProfile->nodes().append(QPointF(time, value));
-                        dataChangedInProfile = true;
-                        // <<< 로직 추가: Y Min/Max 추적 >>>
-                        if (!nodesFound) {
-                            profileMinY = value;
-                            profileMaxY = value;
-                            nodesFound = true;
-                        } else {
-                            if (value < profileMinY) profileMinY = value;
-                            if (value > profileMaxY) profileMaxY = value;
-                        }
-                    } else { qWarning() << "Failed to parse node values:" << pair; }
-                } else { qWarning() << "Invalid node format:" << pair; }
-            }
-        } else {
-            qWarning() << "Unknown or misplaced YAML line:" << line;
-        }
-    }
-    
-    // Handle last profile in file
-    if (currentProfile && dataChangedInProfile) {
-        currentProfile->sortNodes();
-        // <<< 로직 추가: Y Min/Max 설정 >>>
-        if (nodesFound) {
-            currentProfile->setYMin(profileMinY);
-            currentProfile->setYMax(profileMaxY);
-        }
-        currentProfile->emitDataChanged(); // Emit signal *after* setting constraints
+    // Build the profiles before anyone listens to them, so views see each
+    // motor once, complete, instead of rebuilding for every setter
+    for (const MotorData& motorData : data.motors) {
+        MotorProfile* profile = new MotorProfile(motorData.name, QColor::fromRgba(motorData.color), this);
+        profile->setYMin(motorData.yMin);
+        profile->setYMax(motorData.yMax);
+        profile->setMaxSlope(motorData.maxSlope);
+        profile->setInterpolationMode(motorData.interpolation);
+        profile->setNodes(motorData.nodes);
+        m_profiles.append(profile);
     }
+    for (MotorProfile* profile : m_profiles) emit motorAdded(profile);
+    emit modelChanged();
+    if (!m_profiles.isEmpty()) setActiveMotor(m_profiles.first());
+}
 
+// Save all motors to the binary format
+bool MotionDocument::saveToBinary(const QString& filename, const QString& id) const {
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open file for writing:" << filename << file.errorString();
+        return false;
+    }
+    QString error;
+    bool ok = writeBinaryDocument(&file, toData(id), &error);
     file.close();
-    if (!m_profiles.isEmpty()) setActiveMotor(m_profiles.first());
-    return true;
+    if (!ok) qWarning() << "Failed to write binary profile:" << filename << error;
+    return ok;
 }
 
+// Load motors from the binary format (memory-mapped, no text parsing)
+bool MotionDocument::loadFromBinary(const QString& filename) {
+    DocumentReadResult result = readFile(filename, true);
+    if (result.status != DocumentReadStatus::Ok) return false;
+    loadData(result.data);
+    return true;
+}
@@ -7,9 +7,66 @@
 #include <QColor>
 #include <QJsonObject>
 #include <QVariant>
+#include <QHash>
 #include <QTextStream> // For export/import
+#include "documentdata.h" // MotionNode, MotionDocumentData
+#include "documentio.h"   // DocumentReadResult
+#include "profilesampler.h" // ProfileSampler, SegmentPolynomial
 
-using MotionNode = QPointF; // Alias for node data type
+/**
+ * @brief Copy of a profile's nodes together with their IDs.
+ * Both vectors are implicitly shared, so taking a snapshot is O(1) until
+ * the profile is modified.
+ */
+struct NodeSnapshot {
+    QVector<MotionNode> nodes;
+    QVector<quint32> ids;
+};
+
+/**
+ * @brief Net change of one node (by ID) over a batch edit.
+ * A node that was added has existedBefore == false, one that was deleted
+ * has existsAfter == false; otherwise it moved from 'before' to 'after'.
+ */
+struct NodeChange {
+    quint32 id = 0;
+    bool existedBefore = false;
+    MotionNode before;
+    bool existsAfter = false;
+    MotionNode after;
+
+    // Ends where it started (or was added and removed again)
+    bool isNoOp() const {
+        return existedBefore == existsAfter && (!existsAfter || before == after);
+    }
+};
+
+/**
+ * @brief Segments changed since a per-segment cache (polynomials, derivatives)
+ * was last brought up to date.
+ */
+struct SegmentDirtyRange {
+    bool all = true; // Recompute every segment (bulk change, mode change, first use)
+    int first = 0;
+    int last = -1;   // Empty when first > last
+
+    void mark(int firstSegment, int lastSegment) {
+        if (all) return;
+        if (first > last) { first = firstSegment; last = lastSegment; return; }
+        first = qMin(first, firstSegment);
+        last = qMax(last, lastSegment);
+    }
+    // Keeps the range on the same segments after one was inserted at 'segment'
+    void segmentInserted(int segment) {
+        if (first >= segment) ++first;
+        if (last >= segment) ++last;
+    }
+    void segmentRemoved(int segment) {
+        if (first > segment) --first;
+        if (last > segment) --last;
+    }
+    void clear() { all = false; first = 0; last = -1; }
+};
 
 /**
  * @brief Represents the data for a single motor's motion profile.
@@ -27,47 +84,119 @@ public:
     const QString& name() const { return m_name; }
     const QColor& color() const { return m_color; }
     const QVector<MotionNode>& nodes() const { return m_nodes; } // Const getter
-    QVector<MotionNode>& nodes() { return m_nodes; } // <<< Non-const getter added
     double yMin() const { return m_y_min; }
     double yMax() const { return m_y_max; }
     double maxSlope() const { return m_max_slope; }
+    InterpolationMode interpolationMode() const { return m_interpolation; }
     int nodeCount() const { return m_nodes.size(); }
     MotionNode nodeAt(int index) const;
 
-    // Calculates interpolated value at a specific time
+    // Stable node identities: an ID stays with its node while other nodes are
+    // inserted, removed or moved (IDs are never 0)
+    quint32 nodeId(int index) const;
+    int indexOfNode(quint32 id) const; // O(1); -1 if there is no such node
+    // Replaces all nodes (sorted here) and gives them fresh IDs; emits dataChanged
+    void setNodes(const QVector<MotionNode>& nodes);
+
+    // Calculates interpolated value at a specific time (binary search).
+    // For many samples in increasing time, use a ProfileSampler instead.
     double sampleAt(double time) const;
+    // Fills out[0..count) with the values at t0, t0 + dt, t0 + 2*dt, ...
+    void sampleRange(double t0, double dt, int count, double* out) const;
+    // Segment polynomials of the current mode (empty for Linear). Cached like
+    // segmentDerivatives(): after a node edit, the local modes (PCHIP, S-curve)
+    // only refit the segments it can have changed; the splines refit everything
+    const QVector<SegmentPolynomial>& segmentPolynomials() const;
+    // Sampler over the current nodes and mode, sharing the cached polynomials
+    ProfileSampler sampler() const;
+    // Peak |velocity|, |acceleration| and |jerk| of each segment (size
+    // nodeCount() - 1; infinity for a vertical jump, see SegmentDerivatives).
+    // Cached: only the segments an edit can have changed are recomputed on
+    // the next call (all of them for the spline modes, which are global)
+    const QVector<SegmentDerivatives>& segmentDerivatives() const;
+    // Segments (vertical jumps included) above maxSlope(); 0 when there is no limit
+    int slopeViolationCount() const { return countSlopeViolations(segmentDerivatives(), m_max_slope); }
 
     // --- Public internal functions for Undo/Redo ---
-    int internalAddNode(const MotionNode& node);
+    // Each emits one fine-grained signal (nodeInserted/nodeRemoved/nodeMoved)
+    // 'id' = 0 assigns a new ID; undo/redo pass the node's previous ID back in
+    int internalAddNode(const MotionNode& node, quint32 id = 0); // Returns the index it was inserted at
     void internalRemoveNode(int index);
-    void internalMoveNode(int index, const MotionNode& pos);
-    void sortNodes(); // Sorts nodes by X-coordinate (time)
+    int internalMoveNode(int index, const MotionNode& pos); // Re-sorts; returns the new index
     void emitDataChanged(); // Emits dataChanged signal
 
+    // --- Batch editing ---
+    // Between beginBatch() and commitBatch() the internal* functions (and
+    // setNodes/restoreSnapshot) emit nothing; commitBatch() emits a single
+    // dataChanged if anything changed. Batches nest; only the outermost
+    // commit notifies. The outermost commitBatch() returns the net change of
+    // every node the batch touched, for the undo command (see
+    // BatchEditCommand); inner commits return an empty list.
+    void beginBatch();
+    QVector<NodeChange> commitBatch();
+    bool isInBatch() const { return m_batchDepth > 0; }
+
+    NodeSnapshot snapshot() const { return { m_nodes, m_nodeIds }; }
+    void restoreSnapshot(const NodeSnapshot& snapshot); // Emits dataChanged
+
 public slots:
     // Setters for constraints
     void setYMin(double val);
     void setYMax(double val);
     void setMaxSlope(double val);
+    void setInterpolationMode(InterpolationMode mode); // Emits interpolationChanged
     // Applies Y min/max constraints to nodes
     void checkAllNodes();
 
 signals:
-    void dataChanged(); // Emitted when node data changes
+    void dataChanged(); // Emitted after bulk node changes (load, clamp); views rebuild
+    void nodeInserted(int index); // A node was inserted at 'index'
+    void nodeRemoved(int index); // The node at 'index' was removed
+    void nodeMoved(int from, int to); // The node at 'from' got a new position and now sits at 'to'
     void constraintsChanged(); // Emitted when constraint properties change
+    void interpolationChanged(); // The interpolation mode changed; the curve shape did too
 
 private:
     // Basic validation check
     bool isNodeValid(const MotionNode& node, int indexToIgnore = -1) const;
+    // In a batch: records the change and returns true (caller skips its signal)
+    bool deferNotification();
+    // In a batch: remembers the node's state before its first change
+    void recordBatchChange(quint32 id, bool existed, const MotionNode& pos = MotionNode());
+    // Re-syncs m_idToIndex for nodes [first, last] after they shifted
+    void reindexNodeIds(int first, int last);
+    // Called after bulk node changes and mode changes: drops all cached curve data
+    void invalidateInterpolation() { m_polynomialsDirty.all = true; m_derivativesDirty.all = true; }
+    // Called after nodes [first, last] changed: marks the segments touching
+    // those nodes for recomputation in both caches
+    void invalidateNodes(int first, int last);
+    // Keep the caches aligned when a segment is inserted or removed at 'segment'
+    void cachedSegmentInserted(int segment);
+    void cachedSegmentRemoved(int segment);
 
     QString m_name;
     QColor m_color;
     QVector<MotionNode> m_nodes; // Stores nodes sorted by X
+    QVector<quint32> m_nodeIds;  // m_nodeIds[i] is the ID of m_nodes[i]
+    QHash<quint32, int> m_idToIndex;
+    quint32 m_nextNodeId = 1;
+
+    // Batch state
+    int m_batchDepth = 0;
+    bool m_batchChanged = false;
+    QVector<NodeChange> m_batchChanges; // First-touch state of each node changed in the batch
+    QHash<quint32, int> m_batchChangeIndex; // ID -> index into m_batchChanges
 
     // Constraint values
     double m_y_min = -100.0; // Default Y Min
     double m_y_max = 100.0;  // Default Y Max
     double m_max_slope = 1000.0; // Default Max Slope (units: Y-unit / ms)
+
+    InterpolationMode m_interpolation = InterpolationMode::Linear;
+    mutable QVector<SegmentPolynomial> m_polynomials; // Cache for segmentPolynomials()
+    mutable SegmentDirtyRange m_polynomialsDirty;
+    mutable QVector<SegmentDerivatives> m_derivatives; // Cache for segmentDerivatives()
+    mutable SegmentDirtyRange m_derivativesDirty;
 };
 
 
@@ -90,6 +219,24 @@ public:
     bool saveToYAML(const QString& filename, const QString& id) const;
     bool loadFromYAML(const QString& filename);
 
+    // Binary file operations (compact *.mpb format, see binaryformat.h)
+    bool saveToBinary(const QString& filename, const QString& id) const;
+    bool loadFromBinary(const QString& filename);
+
+    /**
+     * @brief Parse stage of loading, safe to run on a worker thread.
+     * readDocumentFile, plus random colors for YAML motors (the format has
+     * none). Touches no document.
+     */
+    static DocumentReadResult readFile(const QString& filename, bool binary,
+                                       const DocumentReadProgress& progress = DocumentReadProgress());
+
+    // Plain copies of the document, used by the file formats
+    MotionDocumentData toData(const QString& id) const;
+    // Replaces all motors in one step (GUI thread): the new profiles are
+    // complete before motorAdded is emitted, and modelChanged fires once
+    void loadData(const MotionDocumentData& data);
+
 public slots:
     // Document modification
     MotorProfile* addMotor(const QString& name, QColor color);
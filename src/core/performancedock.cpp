@@ -0,0 +1,116 @@
+#include "performancedock.h"
+#include "perftrace.h"
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <algorithm> // std::sort
+
+static const int REFRESH_INTERVAL_MS = 500;
+
+PerformanceDock::PerformanceDock(QWidget* parent)
+    : QDockWidget("Performance", parent)
+{
+    setObjectName("PerformanceDock");
+    QWidget* content = new QWidget;
+    QVBoxLayout* layout = new QVBoxLayout(content);
+
+    m_summaryLabel = new QLabel("No data yet");
+    layout->addWidget(m_summaryLabel);
+
+    m_tree = new QTreeWidget;
+    m_tree->setColumnCount(5);
+    m_tree->setHeaderLabels({ "Name", "Calls", "Avg (ms)", "Max (ms)", "Per Frame" });
+    m_tree->setRootIsDecorated(true);
+    m_tree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    layout->addWidget(m_tree);
+
+    QHBoxLayout* buttons = new QHBoxLayout;
+    QPushButton* resetButton = new QPushButton("Reset");
+    QPushButton* exportButton = new QPushButton("Export Chrome Trace...");
+    buttons->addWidget(resetButton);
+    buttons->addStretch();
+    buttons->addWidget(exportButton);
+    layout->addLayout(buttons);
+    setWidget(content);
+
+    connect(resetButton, &QPushButton::clicked, this, &PerformanceDock::onReset);
+    connect(exportButton, &QPushButton::clicked, this, &PerformanceDock::onExportTrace);
+    m_refreshTimer.setInterval(REFRESH_INTERVAL_MS);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &PerformanceDock::refresh);
+    // Only poll while someone is looking
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible) {
+            PerfTrace::instance().takeStats(); // Start a fresh interval
+            m_refreshTimer.start();
+        } else {
+            m_refreshTimer.stop();
+        }
+    });
+}
+
+void PerformanceDock::refresh() {
+    const PerfStats stats = PerfTrace::instance().takeStats();
+    // A frame is one pass of the view's frame scheduler
+    const qint64 frames = stats.counters.value("frames");
+    const double seconds = stats.intervalNs * 1e-9;
+    m_summaryLabel->setText(QString("%1 frames in %2 s (%3 fps), %4 trace events")
+        .arg(frames).arg(seconds, 0, 'f', 2).arg(seconds > 0 ? frames / seconds : 0.0, 0, 'f', 1)
+        .arg(PerfTrace::instance().eventCount()));
+
+    auto perFrame = [frames](double value) { return frames > 0 ? value / frames : value; };
+    m_tree->clear();
+
+    QTreeWidgetItem* scopesItem = new QTreeWidgetItem(m_tree, { "Scopes" });
+    QStringList names = stats.scopes.keys();
+    // Most expensive first
+    std::sort(names.begin(), names.end(), [&stats](const QString& a, const QString& b) {
+        return stats.scopes.value(a).totalNs > stats.scopes.value(b).totalNs;
+    });
+    for (const QString& name : names) {
+        const PerfScopeStats& scope = stats.scopes[name];
+        new QTreeWidgetItem(scopesItem, {
+            name,
+            QString::number(scope.calls),
+            QString::number(scope.totalNs * 1e-6 / qMax<qint64>(scope.calls, 1), 'f', 3),
+            QString::number(scope.maxNs * 1e-6, 'f', 3),
+            QString::number(perFrame(scope.totalNs * 1e-6), 'f', 3) + " ms" });
+    }
+
+    QTreeWidgetItem* countersItem = new QTreeWidgetItem(m_tree, { "Counters" });
+    names = stats.counters.keys();
+    std::sort(names.begin(), names.end());
+    for (const QString& name : names) {
+        const qint64 count = stats.counters[name];
+        new QTreeWidgetItem(countersItem, { name, QString::number(count), QString(), QString(),
+                                            QString::number(perFrame(count), 'f', 2) });
+    }
+
+    QTreeWidgetItem* gaugesItem = new QTreeWidgetItem(m_tree, { "Gauges" });
+    names = stats.gauges.keys();
+    std::sort(names.begin(), names.end());
+    for (const QString& name : names) {
+        new QTreeWidgetItem(gaugesItem, { name, QString::number(stats.gauges[name]) });
+    }
+    m_tree->expandAll();
+}
+
+void PerformanceDock::onReset() {
+    PerfTrace::instance().reset();
+    m_tree->clear();
+    m_summaryLabel->setText("No data yet");
+}
+
+void PerformanceDock::onExportTrace() {
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Chrome Trace", "motion_trace.json",
+                                                    "Chrome Trace (*.json)");
+    if (fileName.isEmpty()) return;
+    QString error;
+    if (!PerfTrace::instance().writeChromeTrace(fileName, &error)) {
+        QMessageBox::warning(this, "File Error", "Could not write the trace file:\n" + error);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QDockWidget>
+#include <QTimer>
+
+class QLabel;
+class QTreeWidget;
+
+/**
+ * @brief Live view of the PERF_* instrumentation (profiling builds only).
+ * Twice a second, while visible, it takes the statistics of the last
+ * interval and lists every timed scope (calls, average, max and time per
+ * frame), the counters (per frame) and the gauges. The recorded events can
+ * be exported as a Chrome trace for chrome://tracing or Perfetto.
+ */
+class PerformanceDock : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit PerformanceDock(QWidget* parent = nullptr);
+
+private slots:
+    void refresh();
+    void onReset();
+    void onExportTrace();
+
+private:
+    QLabel* m_summaryLabel;
+    QTreeWidget* m_tree;
+    QTimer m_refreshTimer;
+};
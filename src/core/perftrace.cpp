@@ -0,0 +1,115 @@
+#include "perftrace.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+PerfTrace& PerfTrace::instance() {
+    static PerfTrace trace;
+    return trace;
+}
+
+PerfTrace::PerfTrace() {
+    m_clock.start();
+}
+
+void PerfTrace::addEvent(const char* name, qint64 startNs, qint64 durationNs) {
+    const quintptr thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    QMutexLocker lock(&m_mutex);
+    PerfEvent event = { name, startNs, durationNs, thread };
+    if (m_events.size() < PERF_TRACE_CAPACITY) {
+        m_events.append(event);
+    } else {
+        m_events[m_nextEvent] = event; // Overwrite the oldest
+        m_wrapped = true;
+    }
+    m_nextEvent = (m_nextEvent + 1) % PERF_TRACE_CAPACITY;
+
+    PerfScopeStats& stats = m_stats.scopes[QString::fromLatin1(name)];
+    ++stats.calls;
+    stats.totalNs += durationNs;
+    stats.maxNs = qMax(stats.maxNs, durationNs);
+}
+
+void PerfTrace::addCount(const char* name, qint64 delta) {
+    QMutexLocker lock(&m_mutex);
+    m_stats.counters[QString::fromLatin1(name)] += delta;
+}
+
+void PerfTrace::setGauge(const char* name, qint64 value) {
+    const qint64 now = nowNs();
+    QMutexLocker lock(&m_mutex);
+    m_stats.gauges[QString::fromLatin1(name)] = value;
+    if (m_gaugeSamples.size() >= PERF_TRACE_CAPACITY) m_gaugeSamples.remove(0, PERF_TRACE_CAPACITY / 2);
+    m_gaugeSamples.append({ name, now, value });
+}
+
+PerfStats PerfTrace::takeStats() {
+    const qint64 now = nowNs();
+    QMutexLocker lock(&m_mutex);
+    PerfStats stats = m_stats;
+    stats.intervalNs = now - m_intervalStartNs;
+    m_intervalStartNs = now;
+    m_stats.scopes.clear();
+    m_stats.counters.clear(); // Gauges keep their last value
+    return stats;
+}
+
+void PerfTrace::reset() {
+    QMutexLocker lock(&m_mutex);
+    m_events.clear();
+    m_nextEvent = 0;
+    m_wrapped = false;
+    m_gaugeSamples.clear();
+    m_stats = PerfStats();
+    m_intervalStartNs = nowNs();
+}
+
+int PerfTrace::eventCount() const {
+    QMutexLocker lock(&m_mutex);
+    return m_events.size();
+}
+
+bool PerfTrace::writeChromeTrace(const QString& filename, QString* errorString) const {
+    QJsonArray traceEvents;
+    {
+        QMutexLocker lock(&m_mutex);
+        // Oldest first; timestamps are in microseconds
+        const int count = m_events.size();
+        const int first = m_wrapped ? m_nextEvent : 0;
+        for (int i = 0; i < count; ++i) {
+            const PerfEvent& event = m_events[(first + i) % count];
+            QJsonObject object;
+            object["name"] = QString::fromLatin1(event.name);
+            object["cat"] = "motion";
+            object["ph"] = "X";
+            object["ts"] = event.startNs / 1000.0;
+            object["dur"] = event.durationNs / 1000.0;
+            object["pid"] = 1;
+            object["tid"] = double(event.thread);
+            traceEvents.append(object);
+        }
+        for (const GaugeSample& sample : m_gaugeSamples) {
+            QJsonObject object;
+            object["name"] = QString::fromLatin1(sample.name);
+            object["ph"] = "C";
+            object["ts"] = sample.timeNs / 1000.0;
+            object["pid"] = 1;
+            object["args"] = QJsonObject{ { "value", double(sample.value) } };
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
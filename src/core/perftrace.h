@@ -0,0 +1,124 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// Most recent scope events kept for the Chrome trace (older ones are dropped)
+const int PERF_TRACE_CAPACITY = 1 << 18;
+
+/**
+ * @brief One timed scope: name, start (ns since the trace clock started),
+ * duration and the thread it ran on.
+ */
+struct PerfEvent {
+    const char* name;
+    qint64 startNs;
+    qint64 durationNs;
+    quintptr thread;
+};
+
+/**
+ * @brief Aggregate of one scope name since the last PerfTrace::takeStats().
+ */
+struct PerfScopeStats {
+    qint64 calls = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+};
+
+/**
+ * @brief Statistics collected between two PerfTrace::takeStats() calls.
+ * Counters are summed over the interval; gauges hold their latest value.
+ */
+struct PerfStats {
+    qint64 intervalNs = 0;
+    QHash<QString, PerfScopeStats> scopes;
+    QHash<QString, qint64> counters;
+    QHash<QString, qint64> gauges;
+};
+
+/**
+ * @brief Process-wide sink for the PERF_* instrumentation macros.
+ * Scope timings feed both the interval statistics (for the performance
+ * dock) and a bounded event buffer that can be written as a Chrome trace
+ * (chrome://tracing, Perfetto). Thread-safe; names must be string literals.
+ * The macros compile to nothing unless MOTION_ENABLE_PROFILING is defined,
+ * so the class costs nothing in normal builds.
+ */
+class PerfTrace {
+public:
+    static PerfTrace& instance();
+
+    qint64 nowNs() const { return m_clock.nsecsElapsed(); }
+    void addEvent(const char* name, qint64 startNs, qint64 durationNs);
+    void addCount(const char* name, qint64 delta);
+    void setGauge(const char* name, qint64 value);
+
+    // Returns the statistics since the previous call and starts a new interval
+    PerfStats takeStats();
+    // Drops all recorded events and statistics
+    void reset();
+
+    int eventCount() const;
+    // Writes the buffered events (and gauge samples) in the Chrome trace
+    // event format; false (with a message) on error
+    bool writeChromeTrace(const QString& filename, QString* errorString = nullptr) const;
+
+private:
+    PerfTrace();
+
+    /**
+     * @brief Gauge value at a point in time, exported as a trace counter.
+     */
+    struct GaugeSample {
+        const char* name;
+        qint64 timeNs;
+        qint64 value;
+    };
+
+    QElapsedTimer m_clock;
+    mutable QMutex m_mutex;
+    QVector<PerfEvent> m_events; // Ring buffer of PERF_TRACE_CAPACITY events
+    int m_nextEvent = 0;
+    bool m_wrapped = false;
+    QVector<GaugeSample> m_gaugeSamples; // Bounded like m_events
+    PerfStats m_stats;
+    qint64 m_intervalStartNs = 0;
+};
+
+/**
+ * @brief Times its own lifetime and reports it to PerfTrace (use PERF_SCOPE).
+ */
+class PerfScope {
+public:
+    explicit PerfScope(const char* name) : m_name(name), m_startNs(PerfTrace::instance().nowNs()) {}
+    ~PerfScope() {
+        PerfTrace& trace = PerfTrace::instance();
+        trace.addEvent(m_name, m_startNs, trace.nowNs() - m_startNs);
+    }
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_startNs;
+};
+
+#define MOTION_PERF_CONCAT_(a, b) a##b
+#define MOTION_PERF_CONCAT(a, b) MOTION_PERF_CONCAT_(a, b)
+
+#ifdef MOTION_ENABLE_PROFILING
+// Times the rest of the enclosing block
+#define PERF_SCOPE(name) PerfScope MOTION_PERF_CONCAT(perfScope_, __LINE__)(name)
+// Adds 'delta' to a per-interval counter (rebuilds, frames, ...)
+#define PERF_COUNT(name, delta) PerfTrace::instance().addCount(name, delta)
+// Records the current value of a quantity (item counts, memory, ...)
+#define PERF_GAUGE(name, value) PerfTrace::instance().setGauge(name, value)
+#else
+#define PERF_SCOPE(name) do {} while (false)
+#define PERF_COUNT(name, delta) do {} while (false)
+#define PERF_GAUGE(name, value) do {} while (false)
+#endif
@@ -0,0 +1,188 @@
+#include "profilecurveitem.h"
+#include "motionmodels.h" // For MotorProfile
+#include <QPainter>
+#include <QPen>
+#include <cmath>   // std::floor, std::ceil
+#include <qmath.h> // qAbs
+
+static const qreal CURVE_PEN_WIDTH = 2.0;
+// Decimate once there are more segments than this per pixel column on screen
+static const double LOD_SEGMENTS_PER_COLUMN = 2.0;
+// Curved (non-linear) interpolation modes: one polyline point per this many
+// pixels of segment width, and at most this many points per segment
+static const double CURVE_PIXELS_PER_POINT = 4.0;
+static const int MAX_CURVE_SUBDIVISIONS = 16;
+
+// Appends points [first, last] to 'path' keeping, per pixel column, the first,
+// lowest, highest and last point in order (M4 envelope)
+static void appendDecimatedRun(QPainterPath& path, const QVector<MotionNode>& nodes,
+                               int first, int last, double columnWidth, qreal yScale) {
+    int emitted = -1;
+    auto emitNode = [&](int index) {
+        if (index == emitted) return;
+        QPointF point(nodes[index].x(), nodes[index].y() * yScale);
+        if (emitted < 0) path.moveTo(point);
+        else path.lineTo(point);
+        emitted = index;
+    };
+
+    int i = first;
+    while (i <= last) {
+        const double column = std::floor(nodes[i].x() / columnWidth);
+        int firstIndex = i, minIndex = i, maxIndex = i, lastIndex = i;
+        for (++i; i <= last && std::floor(nodes[i].x() / columnWidth) == column; ++i) {
+            if (nodes[i].y() < nodes[minIndex].y()) minIndex = i;
+            if (nodes[i].y() > nodes[maxIndex].y()) maxIndex = i;
+            lastIndex = i;
+        }
+        emitNode(firstIndex);
+        emitNode(qMin(minIndex, maxIndex));
+        emitNode(qMax(minIndex, maxIndex));
+        emitNode(lastIndex);
+    }
+}
+
+ProfileCurveItem::ProfileCurveItem(MotorProfile* profile, QGraphicsItem* parent)
+    : QGraphicsItem(parent), m_profile(profile),
+      m_color(profile ? profile->color() : QColor(Qt::gray))
+{
+    setAcceptedMouseButtons(Qt::NoButton); // Clicks go to the node items and the view
+}
+
+void ProfileCurveItem::setColor(const QColor& color) {
+    if (m_color == color) return;
+    m_color = color;
+    update();
+}
+
+void ProfileCurveItem::setYScale(qreal scale) {
+    if (qAbs(scale) < 1e-9) scale = 1.0;
+    if (m_yScale == scale) return;
+    m_yScale = scale;
+    updateCurve();
+}
+
+void ProfileCurveItem::updateCurve() {
+    prepareGeometryChange();
+    m_solidPath = QPainterPath();
+    m_dashedPath = QPainterPath();
+    m_boundingRect = QRectF();
+    m_points.clear();
+    m_runs.clear();
+    m_lodColumnWidth = 0.0;
+    m_lodSolidPath = QPainterPath();
+    m_lodDashedPath = QPainterPath();
+    if (!m_profile) return;
+
+    const QVector<MotionNode>& nodes = m_profile->nodes();
+    const double maxSlopeLimit = m_profile->maxSlope();
+    const SegmentDerivatives* derivatives = m_profile->segmentDerivatives().constData();
+    const bool curved = m_profile->interpolationMode() != InterpolationMode::Linear && nodes.size() > 1;
+    const SegmentPolynomial* polynomials = curved ? m_profile->segmentPolynomials().constData() : nullptr;
+    if (curved) {
+        m_points.reserve(nodes.size());
+        m_points.append(nodes.first());
+    } else {
+        m_points = nodes; // Implicitly shared
+    }
+
+    int runStyle = -1; // 0 = solid, 1 = dashed; a new subpath starts when it changes
+    int point = 0;     // Index in m_points where segment i starts
+    for (int i = 0; i + 1 < nodes.size(); ++i) {
+        const MotionNode& prevNode = nodes[i];
+        const MotionNode& currNode = nodes[i + 1];
+        const double deltaX = currNode.x() - prevNode.x();
+        const bool dashed = maxSlopeLimit > 0 && derivatives[i].velocity > maxSlopeLimit;
+        if (curved) {
+            int steps = 1; // A chord, unless the segment is wide on screen near the visible range
+            if (qAbs(deltaX) > 1e-6 && m_detailPixelsPerUnit > 0
+                && currNode.x() >= m_detailMinX && prevNode.x() <= m_detailMaxX) {
+                const double pixels = deltaX * m_detailPixelsPerUnit;
+                steps = int(qMin(std::ceil(pixels / CURVE_PIXELS_PER_POINT), double(MAX_CURVE_SUBDIVISIONS)));
+                steps = qMax(steps, 1);
+            }
+            for (int k = 1; k < steps; ++k) {
+                const double x = prevNode.x() + deltaX * k / steps;
+                m_points.append(MotionNode(x, polynomials[i].evaluate(prevNode.x(), x)));
+            }
+            m_points.append(currNode);
+        }
+        const int end = curved ? m_points.size() - 1 : i + 1;
+
+        QPainterPath& path = dashed ? m_dashedPath : m_solidPath;
+        if (runStyle != int(dashed)) {
+            path.moveTo(m_points[point].x(), m_points[point].y() * m_yScale);
+            runStyle = int(dashed);
+            m_runs.append({ point, end, dashed });
+        }
+        for (int p = point + 1; p <= end; ++p) path.lineTo(m_points[p].x(), m_points[p].y() * m_yScale);
+        m_runs.last().last = end;
+        point = end;
+    }
+
+    // Same margin a QGraphicsLineItem adds for its pen
+    const qreal margin = CURVE_PEN_WIDTH / 2.0;
+    m_boundingRect = m_solidPath.controlPointRect().united(m_dashedPath.controlPointRect())
+                         .adjusted(-margin, -margin, margin, margin);
+    update();
+}
+
+bool ProfileCurveItem::setDetail(double visibleMinX, double visibleMaxX, qreal pixelsPerUnit) {
+    const bool curved = m_profile && m_profile->interpolationMode() != InterpolationMode::Linear;
+    // Still good: built within a factor of 2 of this zoom, for a range around the visible one
+    const bool zoomKept = m_detailPixelsPerUnit > 0 && pixelsPerUnit <= 2.0 * m_detailPixelsPerUnit
+                          && pixelsPerUnit >= 0.5 * m_detailPixelsPerUnit;
+    const bool rangeKept = visibleMinX >= m_detailMinX && visibleMaxX <= m_detailMaxX;
+    if (curved && zoomKept && rangeKept) return false;
+    // Refine one viewport width beyond each side, so short pans need no rebuild
+    const double width = visibleMaxX - visibleMinX;
+    m_detailPixelsPerUnit = pixelsPerUnit;
+    m_detailMinX = visibleMinX - width;
+    m_detailMaxX = visibleMaxX + width;
+    return curved;
+}
+
+QRectF ProfileCurveItem::boundingRect() const {
+    return m_boundingRect;
+}
+
+void ProfileCurveItem::buildDecimatedPaths(qreal columnWidth) {
+    m_lodColumnWidth = columnWidth;
+    m_lodSolidPath = QPainterPath();
+    m_lodDashedPath = QPainterPath();
+    // m_points is this item's own copy, so it matches m_runs even if the
+    // profile changed since updateCurve() (repaint before the next frame)
+    for (const Run& run : m_runs) {
+        appendDecimatedRun(run.dashed ? m_lodDashedPath : m_lodSolidPath, m_points,
+                           run.first, run.last, columnWidth, m_yScale);
+    }
+}
+
+void ProfileCurveItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    const QPainterPath* solidPath = &m_solidPath;
+    const QPainterPath* dashedPath = &m_dashedPath;
+
+    // Scene X units per device pixel at the current zoom
+    const qreal pixelsPerUnit = qAbs(painter->worldTransform().m11());
+    const int segmentCount = m_points.size() - 1;
+    if (pixelsPerUnit > 1e-12 && segmentCount > 0) {
+        const double columns = qMax(1.0, m_boundingRect.width() * pixelsPerUnit);
+        if (segmentCount > LOD_SEGMENTS_PER_COLUMN * columns) {
+            const qreal columnWidth = 1.0 / pixelsPerUnit;
+            if (columnWidth != m_lodColumnWidth) buildDecimatedPaths(columnWidth);
+            solidPath = &m_lodSolidPath;
+            dashedPath = &m_lodDashedPath;
+        }
+    }
+
+    QPen pen(m_color, CURVE_PEN_WIDTH);
+    pen.setCosmetic(true);
+    painter->setBrush(Qt::NoBrush);
+    painter->setPen(pen);
+    painter->drawPath(*solidPath);
+    pen.setStyle(Qt::DashLine);
+    painter->setPen(pen);
+    painter->drawPath(*dashedPath);
+}
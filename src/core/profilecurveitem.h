@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <QColor>
+#include <QVector>
+#include "documentdata.h" // MotionNode
+
+// Forward declarations
+class MotorProfile;
+
+/**
+ * @brief Draws the whole curve of one motor as a single scene item.
+ * The curve is the one that gets sampled and exported: linear profiles are
+ * drawn through their nodes, other interpolation modes as a polyline evaluated
+ * from the profile's segment polynomials. The polyline is adaptive: segments
+ * near the visible range (see setDetail) get a point every few pixels at the
+ * current zoom, segments far off screen or narrower than that are drawn as
+ * chords, so a long curved profile costs about as much as a linear one.
+ * Segments whose peak velocity (from the profile's cached segment
+ * derivatives) exceeds the max slope, vertical jumps included, are drawn
+ * dashed. Consecutive segments of the same style are joined into runs, and
+ * the runs are cached in two painter paths (solid and dashed) that are only
+ * rebuilt by updateCurve().
+ *
+ * When zoomed out so far that several nodes share a pixel column, a reduced
+ * copy of the paths is drawn instead: per column only the first, lowest,
+ * highest and last point are kept (M4 decimation), which rasterizes to the
+ * same pixels at a paint cost bounded by the curve's width on screen.
+ */
+class ProfileCurveItem : public QGraphicsItem {
+public:
+    enum { Type = UserType + 1 };
+
+    explicit ProfileCurveItem(MotorProfile* profile, QGraphicsItem* parent = nullptr);
+
+    int type() const override { return Type; }
+    MotorProfile* profile() const { return m_profile; }
+
+    void setColor(const QColor& color);
+    void setYScale(qreal scale); // Scene Y per real Y unit (motor visual scale)
+    // Rebuilds the cached paths; call after node or max slope changes
+    void updateCurve();
+    // Visible scene X range and zoom (pixels per scene X unit). Returns true
+    // when a curved profile's polyline is too coarse or too far off screen
+    // for them and updateCurve() should be called; linear curves never need it.
+    bool setDetail(double visibleMinX, double visibleMaxX, qreal pixelsPerUnit);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+private:
+    // Points [first, last] of m_points drawn with one pen style
+    struct Run {
+        int first;
+        int last;
+        bool dashed;
+    };
+
+    void buildDecimatedPaths(qreal columnWidth);
+
+    MotorProfile* m_profile;
+    QColor m_color;
+    qreal m_yScale = 1.0;
+    QVector<MotionNode> m_points; // Drawn polyline in real units (the nodes themselves when linear)
+    QPainterPath m_solidPath;
+    QPainterPath m_dashedPath; // Segments above the max slope
+    QRectF m_boundingRect;
+    QVector<Run> m_runs;
+
+    // Detail the curved polyline was built for (see setDetail)
+    qreal m_detailPixelsPerUnit = 0.0; // 0 until the view reports its zoom: chords only
+    double m_detailMinX = 0.0;         // Segments overlapping [min, max] are subdivided
+    double m_detailMaxX = 0.0;
+
+    // Level-of-detail cache, valid for one column width (scene units per pixel)
+    qreal m_lodColumnWidth = 0.0;
+    QPainterPath m_lodSolidPath;
+    QPainterPath m_lodDashedPath;
+};
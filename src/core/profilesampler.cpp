@@ -0,0 +1,114 @@
+#include "profilesampler.h"
+#include "interpkernel.h"
+#include <algorithm> // std::lower_bound, std::fill
+#include <qmath.h>   // qAbs, qBound, qMin
+
+// Number of segments the cursor walks linearly before falling back to a binary search
+static const int CURSOR_WALK_LIMIT = 8;
+
+ProfileSampler::ProfileSampler(const QVector<MotionNode>& nodes, InterpolationMode mode)
+    : m_nodes(nodes), m_mode(mode), m_segment(0)
+{
+    if (mode != InterpolationMode::Linear) m_polynomials = buildSegmentPolynomials(nodes, mode);
+}
+
+ProfileSampler::ProfileSampler(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                               const QVector<SegmentPolynomial>& polynomials)
+    : m_nodes(nodes), m_mode(mode), m_polynomials(polynomials), m_segment(0)
+{
+    if (mode != InterpolationMode::Linear && m_polynomials.size() != qMax(0, nodes.size() - 1)) {
+        m_polynomials = buildSegmentPolynomials(nodes, mode);
+    }
+}
+
+int ProfileSampler::findSegment(const QVector<MotionNode>& nodes, double time) {
+    // The first node (after the first) at or beyond 'time' closes the segment
+    auto it = std::lower_bound(nodes.constBegin() + 1, nodes.constEnd(), time,
+                               [](const MotionNode& node, double t) { return node.x() < t; });
+    int index = int(it - nodes.constBegin()) - 1;
+    return qBound(0, index, nodes.size() - 2);
+}
+
+double ProfileSampler::interpolate(const MotionNode& prev, const MotionNode& next, double time) {
+    if (qAbs(next.x() - prev.x()) < 1e-6) return prev.y();
+    double t = (time - prev.x()) / (next.x() - prev.x());
+    return prev.y() * (1.0 - t) + next.y() * t;
+}
+
+double ProfileSampler::sampleAt(double time) {
+    if (m_nodes.isEmpty()) return 0.0;
+    if (time <= m_nodes.first().x()) return m_nodes.first().y();
+    if (time >= m_nodes.last().x()) return m_nodes.last().y();
+
+    const int lastIndex = m_nodes.size() - 1;
+    if (m_segment >= lastIndex || time <= m_nodes[m_segment].x()) {
+        // Time moved backwards (or cursor is stale): random access
+        m_segment = findSegment(m_nodes, time);
+    } else if (m_nodes[m_segment + 1].x() < time) {
+        // Time moved forward past the cursor: walk a few segments, search on big jumps
+        const int probe = qMin(m_segment + CURSOR_WALK_LIMIT, lastIndex);
+        if (m_nodes[probe].x() < time) {
+            m_segment = findSegment(m_nodes, time);
+        } else {
+            while (m_nodes[m_segment + 1].x() < time) ++m_segment;
+        }
+    }
+    return evaluateSegment(m_segment, time);
+}
+
+void ProfileSampler::sampleRange(double t0, double dt, int first, int count, double* out) const {
+    if (count <= 0 || !out) return;
+    if (m_nodes.isEmpty()) {
+        std::fill(out, out + count, 0.0);
+        return;
+    }
+    if (dt < 0.0) {
+        ProfileSampler cursor(*this);
+        for (int i = 0; i < count; ++i) out[i] = cursor.sampleAt(t0 + (first + i) * dt);
+        return;
+    }
+
+    const MotionNode* nodes = m_nodes.constData();
+    const int lastIndex = m_nodes.size() - 1;
+    const double firstX = nodes[0].x();
+    const double lastX = nodes[lastIndex].x();
+
+    // Sample indices i run over [first, first + count) and land in out[i - first]
+    const int endIndex = first + count;
+
+    // Before (or at) the first node: hold the first value
+    int i = first;
+    for (; i < endIndex && t0 + i * dt <= firstX; ++i) out[i - first] = nodes[0].y();
+
+    if (i < endIndex && t0 + i * dt < lastX) {
+        int segment = findSegment(m_nodes, t0 + i * dt);
+        while (i < endIndex) {
+            const double time = t0 + i * dt;
+            if (time >= lastX) break;
+            while (nodes[segment + 1].x() < time) ++segment;
+
+            // All following samples up to next.x fall into this segment
+            const MotionNode& prev = nodes[segment];
+            const MotionNode& next = nodes[segment + 1];
+            int end = i + 1;
+            while (end < endIndex) {
+                const double t = t0 + end * dt;
+                if (t > next.x() || t >= lastX) break;
+                ++end;
+            }
+            if (qAbs(next.x() - prev.x()) < 1e-6) {
+                std::fill(out + (i - first), out + (end - first), prev.y());
+            } else if (m_mode != InterpolationMode::Linear) {
+                const SegmentPolynomial& poly = m_polynomials[segment];
+                for (int k = i; k < end; ++k) out[k - first] = poly.evaluate(prev.x(), t0 + k * dt);
+            } else {
+                // Dense run inside one segment: SIMD kernel (same result as interpolate())
+                interpolateLinearRun(prev.x(), prev.y(), next.x(), next.y(), t0, dt, i, end - i, out + (i - first));
+            }
+            i = end;
+        }
+    }
+
+    // At or after the last node: hold the last value
+    for (; i < endIndex; ++i) out[i - first] = nodes[lastIndex].y();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QVector>
+#include "documentdata.h" // For MotionNode
+#include "interpolation.h" // For SegmentPolynomial
+
+/**
+ * @brief Sampling engine over a profile's sorted node vector.
+ * Random access uses a binary search over the nodes; sequential access
+ * (monotonic time, e.g. export or playback) keeps a cursor on the last
+ * segment so walking forward costs O(1) per sample.
+ * Holds an implicitly shared copy of the nodes, so a sampler taken from a
+ * profile stays valid (and consistent) even if the profile is edited later.
+ * Non-linear modes evaluate the precomputed segment polynomials; Linear
+ * interpolates the nodes directly (SIMD kernel for dense ranges).
+ */
+class ProfileSampler {
+public:
+    ProfileSampler() = default;
+    explicit ProfileSampler(const QVector<MotionNode>& nodes,
+                            InterpolationMode mode = InterpolationMode::Linear);
+    // Reuses polynomials already built for 'nodes' (e.g. cached by a MotorProfile)
+    ProfileSampler(const QVector<MotionNode>& nodes, InterpolationMode mode,
+                   const QVector<SegmentPolynomial>& polynomials);
+
+    // Interpolated value at 'time', reusing the cursor when time moves forward
+    double sampleAt(double time);
+    // Fills out[0..count) with the values at t0, t0 + dt, ... (dt >= 0 walks the
+    // segments once; a negative dt falls back to per-sample lookups)
+    void sampleRange(double t0, double dt, int count, double* out) const { sampleRange(t0, dt, 0, count, out); }
+    // Same, for the sub-range of sample indices [first, first + count): out[k] is the
+    // value at t0 + (first + k) * dt, bit-identical to sampling the whole range at once
+    void sampleRange(double t0, double dt, int first, int count, double* out) const;
+    // Rewinds the cursor (only needed for performance, never for correctness)
+    void reset() { m_segment = 0; }
+
+    const QVector<MotionNode>& nodes() const { return m_nodes; }
+    InterpolationMode mode() const { return m_mode; }
+    const QVector<SegmentPolynomial>& polynomials() const { return m_polynomials; }
+
+    // Index i of the segment [i, i+1] with nodes[i].x < time <= nodes[i+1].x
+    // Requires at least two nodes and first.x < time < last.x
+    static int findSegment(const QVector<MotionNode>& nodes, double time);
+    // Linear interpolation inside one segment
+    static double interpolate(const MotionNode& prev, const MotionNode& next, double time);
+
+private:
+    // Value inside 'segment' with the sampler's mode
+    inline double evaluateSegment(int segment, double time) const {
+        if (m_mode == InterpolationMode::Linear) return interpolate(m_nodes[segment], m_nodes[segment + 1], time);
+        return m_polynomials[segment].evaluate(m_nodes[segment].x(), time);
+    }
+
+    QVector<MotionNode> m_nodes;
+    InterpolationMode m_mode = InterpolationMode::Linear;
+    QVector<SegmentPolynomial> m_polynomials; // Empty for Linear
+    int m_segment = 0; // Cursor: last segment used
+};
@@ -0,0 +1,235 @@
+#include "sampleexporter.h"
+#include "yamlwriter.h"
+#include "perftrace.h"
+#include <QSaveFile>
+#include <QFuture>
+#include <QQueue>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <climits> // INT_MAX
+#include <cmath>   // std::floor
+#include <qmath.h> // qMin, qMax
+
+/**
+ * @brief One unit of export work: samples [first, first + count) of a motor,
+ * or of every motor (motor == -1, one CSV row per sample).
+ */
+struct SampleBlock {
+    int motor;
+    int first;
+    int count;
+};
+
+static double exportStepMs(const SampleExportSettings& settings) {
+    double dt_ms = (1.0 / settings.sampleRateHz) * 1000.0;
+    if (dt_ms < 1e-3) dt_ms = 1.0;
+    return dt_ms;
+}
+
+QVector<SampleExportMotor> collectExportMotors(const MotionDocumentData& document) {
+    QVector<SampleExportMotor> motors;
+    for (const MotorData& data : document.motors) {
+        SampleExportMotor motor;
+        motor.keyName = data.name;
+        motor.keyName.replace(':', '_').replace(' ', '_');
+        motor.sampler = ProfileSampler(data.nodes, data.interpolation);
+        motors.append(motor);
+    }
+    return motors;
+}
+
+double defaultExportEndTime(const QVector<SampleExportMotor>& motors) {
+    double endTime = MIN_DEFAULT_EXPORT_END_MS;
+    for (const SampleExportMotor& motor : motors) {
+        const QVector<MotionNode>& nodes = motor.sampler.nodes();
+        if (!nodes.isEmpty()) endTime = qMax(endTime, nodes.last().x());
+    }
+    return endTime;
+}
+
+int exportSampleCount(const SampleExportSettings& settings) {
+    if (settings.sampleRateHz <= 0 || settings.endTimeMs < 0) return 0;
+    // Samples at 0, dt, 2*dt, ...; a final step within half a step past the
+    // end time is clamped to the end time
+    const double steps = std::floor(settings.endTimeMs / exportStepMs(settings) + 0.5);
+    if (!(steps < double(INT_MAX))) return 0; // Too many samples (or NaN)
+    return int(steps) + 1;
+}
+
+QByteArray formatExportHeader(const QString& id) {
+    return "id: " + id.toUtf8() + "\n";
+}
+
+// Values of samples [first, first + count) of one motor; the clamped final
+// sample is taken at the end time itself
+static void sampleExportValues(const SampleExportMotor& motor, const SampleExportSettings& settings,
+                               int first, int count, double* out) {
+    if (count <= 0) return;
+    const double dt_ms = exportStepMs(settings);
+    motor.sampler.sampleRange(0.0, dt_ms, first, count, out);
+    const int lastIndex = exportSampleCount(settings) - 1;
+    if (first + count - 1 == lastIndex && lastIndex * dt_ms > settings.endTimeMs) {
+        ProfileSampler endSampler(motor.sampler); // Same nodes and polynomials, own cursor
+        out[count - 1] = endSampler.sampleAt(settings.endTimeMs);
+    }
+}
+
+QByteArray formatSampleBlock(const SampleExportMotor& motor, const SampleExportSettings& settings,
+                             int first, int count) {
+    YamlWriter out(nullptr, 40 * count + 64); // "[t, v], " is at most ~40 bytes
+    if (first == 0) {
+        out.write("  ").write(motor.keyName).write(":\n");
+        out.write("    - [");
+    }
+
+    const int total = exportSampleCount(settings);
+    if (count > 0) {
+        const double dt_ms = exportStepMs(settings);
+        const double endTimeMs = settings.endTimeMs;
+        QVector<double> values(count);
+        sampleExportValues(motor, settings, first, count, values.data());
+        for (int k = 0; k < count; ++k) {
+            const int i = first + k;
+            double time_ms = qMin(i * dt_ms, endTimeMs);
+            if (i > 0) out.write(", ");
+            out.write("[").writeNumber(time_ms).write(", ").writeNumber(values[k]).write("]");
+        }
+    }
+
+    if (first + count >= total) out.write("]\n");
+    return out.takeBuffer();
+}
+
+// Quotes a CSV header field when it contains a separator or a quote
+static QByteArray csvField(const QString& text) {
+    QByteArray field = text.toUtf8();
+    if (!field.contains(',') && !field.contains('"') && !field.contains('\n')) return field;
+    field.replace("\"", "\"\"");
+    return '"' + field + '"';
+}
+
+QByteArray formatCsvBlock(const QVector<SampleExportMotor>& motors, const SampleExportSettings& settings,
+                          int first, int count) {
+    const int motorCount = motors.size();
+    YamlWriter out(nullptr, 20 * (motorCount + 1) * count + 64); // ~20 bytes per field
+    if (first == 0) {
+        out.write("time_ms");
+        for (const SampleExportMotor& motor : motors) out.write(",").write(csvField(motor.keyName));
+        out.write("\n");
+    }
+    if (count <= 0) return out.takeBuffer();
+
+    // Sample motor by motor (sequential walks), then interleave into rows
+    QVector<double> values(motorCount * count);
+    for (int m = 0; m < motorCount; ++m) {
+        sampleExportValues(motors[m], settings, first, count, values.data() + m * count);
+    }
+    const double dt_ms = exportStepMs(settings);
+    for (int k = 0; k < count; ++k) {
+        out.writeNumber(qMin((first + k) * dt_ms, settings.endTimeMs));
+        for (int m = 0; m < motorCount; ++m) out.write(",").writeNumber(values[m * count + k]);
+        out.write("\n");
+    }
+    return out.takeBuffer();
+}
+
+static QByteArray formatExportBlock(const QVector<SampleExportMotor>& motors, const SampleExportSettings& settings,
+                                    const SampleBlock& block) {
+    PERF_SCOPE("formatExportBlock");
+    if (block.motor < 0) return formatCsvBlock(motors, settings, block.first, block.count);
+    return formatSampleBlock(motors[block.motor], settings, block.first, block.count);
+}
+
+// Splits every motor (YAML) or the rows (CSV) into blocks, in file order
+static QVector<SampleBlock> planBlocks(const QVector<SampleExportMotor>& motors,
+                                       const SampleExportSettings& settings) {
+    QVector<SampleBlock> blocks;
+    const int perMotor = exportSampleCount(settings);
+    if (settings.format == SampleExportFormat::Csv) {
+        blocks.append({ -1, 0, qMin(EXPORT_BLOCK_SAMPLES, perMotor) }); // Header row, at least
+        for (int first = EXPORT_BLOCK_SAMPLES; first < perMotor; first += EXPORT_BLOCK_SAMPLES) {
+            blocks.append({ -1, first, qMin(EXPORT_BLOCK_SAMPLES, perMotor - first) });
+        }
+        return blocks;
+    }
+    for (int m = 0; m < motors.size(); ++m) {
+        if (perMotor == 0) {
+            blocks.append({ m, 0, 0 }); // Header and empty list only
+            continue;
+        }
+        for (int first = 0; first < perMotor; first += EXPORT_BLOCK_SAMPLES) {
+            blocks.append({ m, first, qMin(EXPORT_BLOCK_SAMPLES, perMotor - first) });
+        }
+    }
+    return blocks;
+}
+
+SampleExportResult exportSamples(QIODevice* device, const QString& id,
+                                 const QVector<SampleExportMotor>& motors,
+                                 const SampleExportSettings& settings,
+                                 const SampleExportProgress& progress) {
+    PERF_SCOPE("exportSamples");
+    SampleExportResult result;
+    const QByteArray header = settings.format == SampleExportFormat::Yaml ? formatExportHeader(id) : QByteArray();
+    if (!device || device->write(header) != header.size()) {
+        result.status = SampleExportStatus::WriteFailed;
+        result.errorString = device ? device->errorString() : QString("No output device");
+        return result;
+    }
+
+    const QVector<SampleBlock> blocks = planBlocks(motors, settings);
+    const int totalBlocks = blocks.size();
+
+    // Producer stage: a private pool, so the formatting tasks never wait
+    // behind (or deadlock with) work on the global pool
+    QThreadPool pool;
+    if (settings.maxThreads > 0) pool.setMaxThreadCount(settings.maxThreads);
+    const int maxInFlight = qMax(2, pool.maxThreadCount() * 2);
+    QQueue<QFuture<QByteArray>> inFlight;
+    int submitted = 0;
+    int written = 0;
+
+    // Writer stage: consume finished blocks strictly in order
+    while (written < totalBlocks) {
+        while (result.status == SampleExportStatus::Ok && submitted < totalBlocks && inFlight.size() < maxInFlight) {
+            const SampleBlock& block = blocks[submitted++];
+            inFlight.enqueue(QtConcurrent::run(&pool, formatExportBlock, motors, settings, block));
+        }
+        if (inFlight.isEmpty()) break;
+
+        QByteArray chunk = inFlight.dequeue().result();
+        if (result.status != SampleExportStatus::Ok) continue; // Draining after cancel/error
+        if (device->write(chunk) != chunk.size()) {
+            result.status = SampleExportStatus::WriteFailed;
+            result.errorString = device->errorString();
+            continue;
+        }
+        ++written;
+        if (progress && !progress(written, totalBlocks)) {
+            result.status = SampleExportStatus::Canceled;
+        }
+    }
+    pool.waitForDone();
+    return result;
+}
+
+SampleExportResult exportSamplesToFile(const QString& fileName, const QString& id,
+                                       const QVector<SampleExportMotor>& motors,
+                                       const SampleExportSettings& settings,
+                                       const SampleExportProgress& progress) {
+    SampleExportResult result;
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        result.status = SampleExportStatus::OpenFailed;
+        result.errorString = file.errorString();
+        return result;
+    }
+    result = exportSamples(&file, id, motors, settings, progress);
+    if (result.status != SampleExportStatus::Ok) {
+        file.cancelWriting(); // Discards the temporary file
+    } else if (!file.commit()) {
+        result.status = SampleExportStatus::WriteFailed;
+        result.errorString = file.errorString();
+    }
+    return result;
+}
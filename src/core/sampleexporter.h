@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "profilesampler.h" // For ProfileSampler
+#include "documentdata.h"   // For MotionDocumentData
+
+class QIODevice;
+
+// Samples per streamed block; each block is sampled and formatted independently
+const int EXPORT_BLOCK_SAMPLES = 8192;
+
+// Shortest default export length: the end time offered for short profiles
+const double MIN_DEFAULT_EXPORT_END_MS = 2000.0;
+
+enum class SampleExportFormat {
+    Yaml, // "id:" header, then one "[time, value]" list per motor
+    Csv   // One row per sample time: "time_ms,<motor>,<motor>,..."
+};
+
+/**
+ * @brief Options for the sampled export.
+ */
+struct SampleExportSettings {
+    double sampleRateHz = 100.0;
+    double endTimeMs = MIN_DEFAULT_EXPORT_END_MS;
+    SampleExportFormat format = SampleExportFormat::Yaml;
+    int maxThreads = 0; // Formatting threads per export; 0 uses one per core
+};
+
+/**
+ * @brief Snapshot of one motor for export.
+ * Owns an implicitly shared copy of the nodes, so it can be formatted on a
+ * worker thread while the document keeps being edited on the GUI thread.
+ */
+struct SampleExportMotor {
+    QString keyName;
+    ProfileSampler sampler;
+};
+
+enum class SampleExportStatus {
+    Ok,
+    Canceled,
+    OpenFailed,
+    WriteFailed
+};
+
+struct SampleExportResult {
+    SampleExportStatus status = SampleExportStatus::Ok;
+    QString errorString;
+};
+
+// Progress callback: (blocks written, total blocks); return false to cancel.
+// Called on the thread running the export.
+using SampleExportProgress = std::function<bool(int, int)>;
+
+// Takes export snapshots of all motors, in document order (the nodes are
+// implicitly shared, so this is cheap)
+QVector<SampleExportMotor> collectExportMotors(const MotionDocumentData& document);
+
+// Default end time: the last node of the longest motor, at least MIN_DEFAULT_EXPORT_END_MS
+double defaultExportEndTime(const QVector<SampleExportMotor>& motors);
+
+// Number of samples written per motor (0 when the settings are invalid or
+// would need more than INT_MAX samples)
+int exportSampleCount(const SampleExportSettings& settings);
+
+// "id: <id>" header line of a YAML export file
+QByteArray formatExportHeader(const QString& id);
+
+// YAML text for samples [first, first + count) of one motor, including the
+// motor header before sample 0 and the closing bracket after the last sample
+// (thread-safe, no shared state)
+QByteArray formatSampleBlock(const SampleExportMotor& motor, const SampleExportSettings& settings,
+                             int first, int count);
+
+// CSV rows for sample times [first, first + count) across all motors,
+// preceded by the column header row when first == 0 (thread-safe)
+QByteArray formatCsvBlock(const QVector<SampleExportMotor>& motors, const SampleExportSettings& settings,
+                          int first, int count);
+
+/**
+ * @brief Streams a sampled export to 'device', in settings.format.
+ * Blocks of EXPORT_BLOCK_SAMPLES samples (per motor for YAML, rows for CSV)
+ * are sampled and formatted on a private thread pool while this thread
+ * writes finished blocks in document order. Only a bounded number of blocks
+ * is in flight, so peak memory does not depend on the profile length or the
+ * sample rate. The id is only written to YAML.
+ */
+SampleExportResult exportSamples(QIODevice* device, const QString& id,
+                                 const QVector<SampleExportMotor>& motors,
+                                 const SampleExportSettings& settings,
+                                 const SampleExportProgress& progress = SampleExportProgress());
+
+// Same, writing to a file through QSaveFile: the file is only replaced once
+// the export succeeded, so a cancel or error leaves any previous file intact
+SampleExportResult exportSamplesToFile(const QString& fileName, const QString& id,
+                                       const QVector<SampleExportMotor>& motors,
+                                       const SampleExportSettings& settings,
+                                       const SampleExportProgress& progress = SampleExportProgress());
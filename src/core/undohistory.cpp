@@ -0,0 +1,200 @@
+#include "undohistory.h"
+#include "perftrace.h"
+#include <QAction>
+
+qint64 UndoCommand::baseMemoryCost(size_t objectSize) const {
+    return qint64(objectSize) + 64 + qint64(text().size()) * qint64(sizeof(QChar));
+}
+
+UndoHistory::UndoHistory(QObject* parent) : QObject(parent) {}
+
+UndoHistory::~UndoHistory() {
+    qDeleteAll(m_commands);
+}
+
+qint64 UndoHistory::costOf(const QUndoCommand* command) {
+    if (const UndoCommand* counted = dynamic_cast<const UndoCommand*>(command)) {
+        return counted->memoryCost();
+    }
+    qint64 cost = 64 + qint64(command->text().size()) * qint64(sizeof(QChar));
+    for (int i = 0; i < command->childCount(); ++i) cost += costOf(command->child(i));
+    return cost;
+}
+
+QString UndoHistory::undoText() const {
+    return canUndo() ? m_commands[m_index - 1]->text() : QString();
+}
+
+QString UndoHistory::redoText() const {
+    return canRedo() ? m_commands[m_index]->text() : QString();
+}
+
+void UndoHistory::push(QUndoCommand* command) {
+    if (!command) return;
+    PERF_SCOPE("UndoHistory::push");
+    command->redo();
+    deleteRedoTail();
+
+    // Same merge rule as QUndoStack: equal ids (not -1) and mergeWith() agrees
+    if (m_index > 0) {
+        QUndoCommand* top = m_commands[m_index - 1];
+        if (command->id() != -1 && top->id() == command->id() && top->mergeWith(command)) {
+            delete command;
+            m_usage -= m_costs[m_index - 1];
+            m_costs[m_index - 1] = costOf(top);
+            m_usage += m_costs[m_index - 1];
+            trimToBudget();
+            emitStateChanged();
+            return;
+        }
+    }
+
+    m_commands.append(command);
+    m_costs.append(costOf(command));
+    m_usage += m_costs.last();
+    m_index = m_commands.size();
+    trimToBudget();
+    emitStateChanged();
+}
+
+void UndoHistory::undo() {
+    if (!canUndo()) return;
+    PERF_SCOPE("UndoHistory::undo");
+    m_commands[--m_index]->undo();
+    emitStateChanged();
+}
+
+void UndoHistory::redo() {
+    if (!canRedo()) return;
+    PERF_SCOPE("UndoHistory::redo");
+    m_commands[m_index++]->redo();
+    emitStateChanged();
+}
+
+void UndoHistory::clear() {
+    qDeleteAll(m_commands);
+    m_commands.clear();
+    m_costs.clear();
+    m_index = 0;
+    m_cleanIndex = 0;
+    m_usage = 0;
+    m_discardedCount = 0;
+    m_compactedCount = 0;
+    emitStateChanged();
+}
+
+void UndoHistory::setClean() {
+    m_cleanIndex = m_index;
+    emitStateChanged();
+}
+
+void UndoHistory::setMemoryBudget(qint64 bytes) {
+    m_budget = qMax<qint64>(0, bytes);
+    trimToBudget();
+    emitStateChanged();
+}
+
+void UndoHistory::deleteRedoTail() {
+    while (m_commands.size() > m_index) removeNewest();
+}
+
+void UndoHistory::removeNewest() {
+    m_usage -= m_costs.takeLast();
+    delete m_commands.takeLast();
+    if (m_cleanIndex > m_commands.size()) m_cleanIndex = -1;
+}
+
+void UndoHistory::removeOldest(int count) {
+    for (int i = 0; i < count; ++i) {
+        m_usage -= m_costs[i];
+        delete m_commands[i];
+    }
+    m_commands.erase(m_commands.begin(), m_commands.begin() + count);
+    m_costs.erase(m_costs.begin(), m_costs.begin() + count);
+    m_index -= count;
+    m_cleanIndex = m_cleanIndex >= count ? m_cleanIndex - count : -1;
+}
+
+bool UndoHistory::compactOldest() {
+    const int count = m_index - 1;
+    if (!m_compactor || count < 2) return false;
+    QUndoCommand* checkpoint = m_compactor(m_commands.mid(0, count));
+    if (!checkpoint) return false;
+    const qint64 cost = costOf(checkpoint);
+    // A checkpoint this large would be compacted again on nearly every push
+    if (cost > m_budget / 2) {
+        delete checkpoint;
+        return false;
+    }
+    // States inside the merged range are no longer reachable; the end state is
+    const int cleanIndex = m_cleanIndex;
+    removeOldest(count);
+    m_commands.prepend(checkpoint);
+    m_costs.prepend(cost);
+    m_usage += cost;
+    ++m_index;
+    m_cleanIndex = cleanIndex == count ? 1 : (cleanIndex > count ? cleanIndex - count + 1 : -1);
+    m_compactedCount += count;
+    return true;
+}
+
+void UndoHistory::trimToBudget() {
+    if (m_usage <= m_budget) return;
+    PERF_SCOPE("UndoHistory::trimToBudget");
+    // The newest done command is always kept, so the last edit can be undone
+    if (!compactOldest()) {
+        int drop = 0;
+        qint64 usage = m_usage;
+        while (usage > m_budget && drop < m_index - 1) usage -= m_costs[drop++];
+        if (drop > 0) {
+            removeOldest(drop);
+            m_discardedCount += drop;
+        }
+    }
+    // After many undos most of the memory sits in the redo commands
+    while (m_usage > m_budget && m_commands.size() > m_index) {
+        removeNewest();
+        ++m_discardedCount;
+    }
+}
+
+void UndoHistory::emitStateChanged() {
+    PERF_GAUGE("undo memory (KB)", m_usage / 1024);
+    emit indexChanged(m_index);
+    emit canUndoChanged(canUndo());
+    emit canRedoChanged(canRedo());
+    emit undoTextChanged(undoText());
+    emit redoTextChanged(redoText());
+    if (isClean() != m_wasClean) {
+        m_wasClean = isClean();
+        emit cleanChanged(m_wasClean);
+    }
+}
+
+static QString actionText(const QString& prefix, const QString& defaultPrefix, const QString& commandText) {
+    QString text = prefix.isEmpty() ? defaultPrefix : prefix;
+    if (!commandText.isEmpty()) text += " " + commandText;
+    return text;
+}
+
+QAction* UndoHistory::createUndoAction(QObject* parent, const QString& prefix) const {
+    QAction* action = new QAction(actionText(prefix, "Undo", undoText()), parent);
+    action->setEnabled(canUndo());
+    connect(this, &UndoHistory::canUndoChanged, action, &QAction::setEnabled);
+    connect(this, &UndoHistory::undoTextChanged, action, [action, prefix](const QString& text) {
+        action->setText(actionText(prefix, "Undo", text));
+    });
+    connect(action, &QAction::triggered, this, &UndoHistory::undo);
+    return action;
+}
+
+QAction* UndoHistory::createRedoAction(QObject* parent, const QString& prefix) const {
+    QAction* action = new QAction(actionText(prefix, "Redo", redoText()), parent);
+    action->setEnabled(canRedo());
+    connect(this, &UndoHistory::canRedoChanged, action, &QAction::setEnabled);
+    connect(this, &UndoHistory::redoTextChanged, action, [action, prefix](const QString& text) {
+        action->setText(actionText(prefix, "Redo", text));
+    });
+    connect(action, &QAction::triggered, this, &UndoHistory::redo);
+    return action;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QUndoCommand>
+#include <functional>
+
+class QAction;
+
+/**
+ * @brief QUndoCommand that reports how much memory it keeps alive.
+ * Every command implements memoryCost(), at least as
+ * baseMemoryCost(sizeof(*this)), so UndoHistory accounts for the size of the
+ * derived object; commands owning node data add it on top.
+ */
+class UndoCommand : public QUndoCommand {
+public:
+    explicit UndoCommand(QUndoCommand* parent = nullptr) : QUndoCommand(parent) {}
+    // Approximate bytes owned by the command, including its text
+    virtual qint64 memoryCost() const = 0;
+
+protected:
+    // An object of 'objectSize' bytes, its QUndoCommand private data and the text
+    qint64 baseMemoryCost(size_t objectSize) const;
+};
+
+// Default undo memory budget (bytes)
+const qint64 DEFAULT_UNDO_MEMORY_BUDGET = 64ll * 1024 * 1024;
+
+/**
+ * @brief Undo/redo history with a memory budget.
+ * Works like QUndoStack (push() runs redo() and merges with the top command
+ * when the ids match), but every command's memoryCost() is accounted for.
+ * When the total goes over the budget, all done commands but the newest are
+ * compacted: the compactor (see setCompactor) merges them into one checkpoint
+ * command that undoes them together, so the edits stay undoable. Only if
+ * there is no compactor, it declines, or the checkpoint alone would take more
+ * than half the budget, are the oldest done commands deleted instead; then,
+ * if still needed, the redo commands furthest from the current index.
+ * The newest done command is always kept. Undo and redo stay O(1) per
+ * command however long the session is.
+ */
+class UndoHistory : public QObject {
+    Q_OBJECT
+
+public:
+    explicit UndoHistory(QObject* parent = nullptr);
+    ~UndoHistory();
+
+    // Merges done commands (oldest first) into one command in the done state,
+    // or returns nullptr if they cannot be merged
+    using Compactor = std::function<QUndoCommand*(const QList<QUndoCommand*>& commands)>;
+    void setCompactor(const Compactor& compactor) { m_compactor = compactor; }
+
+    void push(QUndoCommand* command); // Takes ownership
+    void clear();
+
+    // Clean state (e.g. the saved document), as in QUndoStack. The clean
+    // index is lost (-1) when the commands around it are compacted or deleted.
+    void setClean();
+    bool isClean() const { return m_cleanIndex == m_index; }
+    int cleanIndex() const { return m_cleanIndex; }
+
+    bool canUndo() const { return m_index > 0; }
+    bool canRedo() const { return m_index < m_commands.size(); }
+    QString undoText() const;
+    QString redoText() const;
+    int count() const { return m_commands.size(); }
+    int index() const { return m_index; }
+
+    // Memory accounting
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_budget; }
+    qint64 memoryUsage() const { return m_usage; }
+    int discardedCount() const { return m_discardedCount; } // Commands dropped to stay within the budget
+    int compactedCount() const { return m_compactedCount; } // Commands merged into checkpoints
+
+    // Actions that follow canUndo()/canRedo() and the command texts
+    QAction* createUndoAction(QObject* parent, const QString& prefix = QString()) const;
+    QAction* createRedoAction(QObject* parent, const QString& prefix = QString()) const;
+
+public slots:
+    void undo();
+    void redo();
+
+signals:
+    void indexChanged(int index);
+    void canUndoChanged(bool canUndo);
+    void canRedoChanged(bool canRedo);
+    void undoTextChanged(const QString& text);
+    void redoTextChanged(const QString& text);
+    void cleanChanged(bool clean);
+
+private:
+    static qint64 costOf(const QUndoCommand* command);
+    void deleteRedoTail();
+    void trimToBudget(); // Compacts (or drops) the oldest, then drops the furthest redo commands
+    bool compactOldest(); // Merges [0, m_index - 1) into one checkpoint; false if not possible
+    void removeOldest(int count); // Deletes commands [0, count) and shifts the indexes
+    void removeNewest(); // Deletes the last command
+    void emitStateChanged();
+
+    QList<QUndoCommand*> m_commands;
+    QList<qint64> m_costs; // Cost of each command, as last accounted
+    int m_index = 0;       // Commands [0, m_index) are done
+    int m_cleanIndex = 0;  // -1 when the clean state is no longer reachable
+    bool m_wasClean = true;
+    Compactor m_compactor;
+    qint64 m_budget = DEFAULT_UNDO_MEMORY_BUDGET;
+    qint64 m_usage = 0;
+    int m_discardedCount = 0;
+    int m_compactedCount = 0;
+};
@@ -0,0 +1,227 @@
+#include "yamlparser.h"
+#include "interpolation.h"
+#include <QFile>
+#include <charconv>    // std::from_chars
+#include <string_view>
+
+using std::string_view;
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static string_view trimmed(string_view text) {
+    while (!text.empty() && isBlank(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isBlank(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+static bool startsWith(string_view text, string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+static QString toQString(string_view text) {
+    return QString::fromUtf8(text.data(), int(text.size()));
+}
+
+/**
+ * @brief Parses the node pairs of one "- [[x, y], ...]" line.
+ * 'p' walks the bytes between "- [" and the closing ']' of the line.
+ */
+class NodeListParser {
+public:
+    NodeListParser(const char* lineStart, int lineNumber, MotorData* motor,
+                   QVector<YamlParseIssue>* issues)
+        : m_lineStart(lineStart), m_lineNumber(lineNumber), m_motor(motor), m_issues(issues) {}
+
+    // Returns the number of nodes appended; updates the running Y range
+    int parse(string_view body, double* minY, double* maxY, bool* nodesFound) {
+        const char* p = body.data();
+        const char* end = p + body.size();
+        int appended = 0;
+        skipBlanks(p, end);
+        while (p < end) {
+            double x, y;
+            const char* pairStart = p;
+            if (parsePair(p, end, &x, &y)) {
+                m_motor->nodes.append(MotionNode(x, y));
+                ++appended;
+                if (!*nodesFound) {
+                    *minY = y;
+                    *maxY = y;
+                    *nodesFound = true;
+                } else {
+                    if (y < *minY) *minY = y;
+                    if (y > *maxY) *maxY = y;
+                }
+            } else {
+                // Skip the rest of the malformed pair
+                p = pairStart;
+                while (p < end && *p != ']') ++p;
+                if (p < end) ++p;
+            }
+            skipBlanks(p, end);
+            if (p >= end) break;
+            if (*p != ',') {
+                report(p, "expected ',' between node pairs");
+                break;
+            }
+            ++p;
+            skipBlanks(p, end);
+            if (p >= end) report(p, "expected '[' after ','");
+        }
+        return appended;
+    }
+
+private:
+    static void skipBlanks(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    }
+
+    // "[x, y]"; on failure reports the position and returns false
+    bool parsePair(const char*& p, const char* end, double* x, double* y) {
+        if (*p != '[') return report(p, "expected '[' to start a node pair");
+        ++p;
+        skipBlanks(p, end);
+        if (!parseNumber(p, end, x)) return report(p, "invalid time value");
+        skipBlanks(p, end);
+        if (p >= end || *p != ',') return report(p, "expected ',' between time and value");
+        ++p;
+        skipBlanks(p, end);
+        if (!parseNumber(p, end, y)) return report(p, "invalid node value");
+        skipBlanks(p, end);
+        if (p >= end || *p != ']') return report(p, "expected ']' to close the node pair");
+        ++p;
+        return true;
+    }
+
+    // Same syntax QString::toDouble accepts (C locale), including a leading '+'
+    static bool parseNumber(const char*& p, const char* end, double* value) {
+        const char* start = p;
+        if (start < end && *start == '+') {
+            ++start;
+            if (start < end && (*start == '+' || *start == '-')) return false;
+        }
+        std::from_chars_result result = std::from_chars(start, end, *value);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool report(const char* at, const char* message) {
+        if (m_issues) {
+            YamlParseIssue issue;
+            issue.line = m_lineNumber;
+            issue.column = int(at - m_lineStart) + 1;
+            issue.message = QString::fromLatin1(message);
+            m_issues->append(issue);
+        }
+        return false;
+    }
+
+    const char* m_lineStart;
+    int m_lineNumber;
+    MotorData* m_motor;
+    QVector<YamlParseIssue>* m_issues;
+};
+
+bool parseMotionYaml(const char* data, qint64 size, MotionDocumentData* document,
+                     QVector<YamlParseIssue>* issues, const DocumentReadProgress& progress) {
+    if (!document) return false;
+    *document = MotionDocumentData();
+    const int issuesBefore = issues ? issues->size() : 0;
+
+    string_view text(data, size_t(qMax<qint64>(size, 0)));
+    if (startsWith(text, "\xEF\xBB\xBF")) text.remove_prefix(3); // UTF-8 BOM
+
+    int currentMotor = -1; // Index (the motor vector may reallocate while growing)
+    double profileMinY = 0.0;
+    double profileMaxY = 0.0;
+    bool nodesFound = false;
+
+    // Applies the tracked Y range to the motor that just ended
+    auto finishMotor = [&]() {
+        if (currentMotor < 0) return;
+        MotorData& motor = document->motors[currentMotor];
+        sortMotionNodes(motor.nodes);
+        if (nodesFound) {
+            motor.yMin = profileMinY;
+            motor.yMax = profileMaxY;
+        }
+    };
+
+    int lineNumber = 0;
+    size_t lineBegin = 0;
+    size_t nextReport = 0;
+    while (lineBegin < text.size()) {
+        if (progress && lineBegin >= nextReport) {
+            if (!progress(qint64(lineBegin), qint64(text.size()))) return false;
+            nextReport = lineBegin + size_t(YAML_PROGRESS_INTERVAL);
+        }
+        size_t lineEnd = text.find('\n', lineBegin);
+        if (lineEnd == string_view::npos) lineEnd = text.size();
+        string_view rawLine = text.substr(lineBegin, lineEnd - lineBegin);
+        const char* lineStart = rawLine.data();
+        lineBegin = lineEnd + 1;
+        ++lineNumber;
+
+        string_view line = trimmed(rawLine);
+        if (line.empty() || line.front() == '#') continue;
+
+        if (startsWith(line, "id:")) {
+            document->id = toQString(trimmed(line.substr(3)));
+        }
+        else if (startsWith(line, "interpolation:") && line.back() != ':' && currentMotor >= 0) {
+            string_view name = trimmed(line.substr(14));
+            if (!parseInterpolationMode(toQString(name), &document->motors[currentMotor].interpolation) && issues) {
+                YamlParseIssue issue;
+                issue.line = lineNumber;
+                issue.column = int(name.data() - lineStart) + 1;
+                issue.message = "unknown interpolation mode: " + toQString(name);
+                issues->append(issue);
+            }
+        }
+        else if (line.back() == ':') { // Motor definition
+            finishMotor();
+            MotorData motor;
+            motor.name = toQString(trimmed(line.substr(0, line.size() - 1)));
+            document->motors.append(motor);
+            currentMotor = document->motors.size() - 1;
+            nodesFound = false;
+        }
+        else if (startsWith(line, "- [") && line.back() == ']' && currentMotor >= 0) { // Node list
+            string_view body = line.substr(3, line.size() - 4);
+            NodeListParser parser(lineStart, lineNumber, &document->motors[currentMotor], issues);
+            parser.parse(body, &profileMinY, &profileMaxY, &nodesFound);
+        }
+        else if (issues) {
+            YamlParseIssue issue;
+            issue.line = lineNumber;
+            issue.column = int(line.data() - lineStart) + 1;
+            issue.message = "unknown or misplaced line: " + toQString(line);
+            issues->append(issue);
+        }
+    }
+    finishMotor();
+    if (progress && !progress(qint64(text.size()), qint64(text.size()))) return false;
+    return !issues || issues->size() == issuesBefore;
+}
+
+bool readMotionYaml(const QString& filename, MotionDocumentData* document,
+                    QVector<YamlParseIssue>* issues, QString* errorString,
+                    const DocumentReadProgress& progress) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    // Parse straight from a memory map when possible, otherwise from one read
+    const qint64 size = file.size();
+    if (size > 0) {
+        if (const uchar* mapped = file.map(0, size)) {
+            return parseMotionYaml(reinterpret_cast<const char*>(mapped), size, document, issues, progress);
+        }
+    }
+    QByteArray bytes = file.readAll();
+    return parseMotionYaml(bytes.constData(), bytes.size(), document, issues, progress);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include "documentdata.h"
+
+/**
+ * @brief A problem found while parsing a motion YAML file.
+ * Line and column are 1-based; the column counts UTF-8 bytes.
+ */
+struct YamlParseIssue {
+    int line = 0;
+    int column = 0;
+    QString message;
+};
+
+// Bytes parsed between two progress reports
+const qint64 YAML_PROGRESS_INTERVAL = 1 << 20;
+
+/**
+ * @brief Single-pass parser for the motion YAML format written by saveToYAML.
+ * Works directly on the UTF-8 bytes (string_view + std::from_chars) and
+ * appends nodes straight into each motor's node vector, without building
+ * temporary QStrings or QStringLists per node.
+ * Accepts exactly what the previous QString-based loader accepted on valid
+ * files; malformed lines or node pairs are skipped and reported as issues.
+ * An optional "interpolation: <mode>" line after a motor sets its mode
+ * (see interpolationModeName); motors without one are linear.
+ * Motors get their Y range from the parsed values (defaults when there are
+ * no nodes) and their nodes sorted by X; colors are left to the caller.
+ * 'progress' gets (bytes parsed, total bytes) about every
+ * YAML_PROGRESS_INTERVAL bytes; when it returns false parsing stops and
+ * 'document' is left incomplete.
+ * Returns true if there were no issues and parsing was not canceled.
+ */
+bool parseMotionYaml(const char* data, qint64 size, MotionDocumentData* document,
+                     QVector<YamlParseIssue>* issues = nullptr,
+                     const DocumentReadProgress& progress = DocumentReadProgress());
+
+// Maps (or reads) 'filename' and parses it. Returns false with 'errorString'
+// set if the file cannot be read; otherwise the result of parseMotionYaml
+bool readMotionYaml(const QString& filename, MotionDocumentData* document,
+                    QVector<YamlParseIssue>* issues = nullptr, QString* errorString = nullptr,
+                    const DocumentReadProgress& progress = DocumentReadProgress());
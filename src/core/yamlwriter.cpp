@@ -0,0 +1,62 @@
+#include "yamlwriter.h"
+#include <QIODevice>
+#include <charconv> // std::to_chars
+#include <cstring>  // strlen, memcpy
+#include <qmath.h>  // qMax
+
+// Longest %.10g output: sign, 10 digits, point, "e-308"
+static const int MAX_NUMBER_LENGTH = 32;
+
+YamlWriter::YamlWriter(QIODevice* device, int capacity)
+    : m_device(device), m_buffer(qMax(capacity, MAX_NUMBER_LENGTH), Qt::Uninitialized)
+{
+    m_data = m_buffer.data();
+}
+
+YamlWriter::~YamlWriter() {
+    if (m_device) flush();
+}
+
+YamlWriter& YamlWriter::write(const char* text) {
+    return write(text, int(std::strlen(text)));
+}
+
+YamlWriter& YamlWriter::write(const char* data, int size) {
+    if (size <= 0) return *this;
+    reserve(size);
+    std::memcpy(m_data + m_size, data, size_t(size));
+    m_size += size;
+    return *this;
+}
+
+YamlWriter& YamlWriter::writeNumber(double value) {
+    reserve(MAX_NUMBER_LENGTH);
+    // 'general' with precision 10 follows printf("%.10g"), which is what
+    // QString::number(value, 'g', 10) produces for the C locale
+    std::to_chars_result result = std::to_chars(m_data + m_size, m_data + m_size + MAX_NUMBER_LENGTH,
+                                                value, std::chars_format::general, 10);
+    m_size = int(result.ptr - m_data);
+    return *this;
+}
+
+bool YamlWriter::flush() {
+    if (!m_device || m_size == 0) return !m_error;
+    if (m_device->write(m_data, m_size) != m_size) m_error = true;
+    m_size = 0;
+    return !m_error;
+}
+
+QByteArray YamlWriter::takeBuffer() {
+    QByteArray result(m_data, m_size);
+    m_size = 0;
+    return result;
+}
+
+void YamlWriter::makeRoom(int bytes) {
+    if (m_device) {
+        flush();
+        if (bytes <= m_buffer.size()) return;
+    }
+    m_buffer.resize(qMax(m_buffer.size() * 2, m_size + bytes));
+    m_data = m_buffer.data();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+
+/**
+ * @brief Buffered byte writer for the YAML files (documents and sample exports).
+ * Text goes into one reusable char buffer and numbers are formatted in place
+ * with std::to_chars, so there is no per-number allocation or codec pass.
+ * With a device, the buffer is flushed whenever it fills up (and on destruction);
+ * without one, it grows and the result is taken with takeBuffer().
+ */
+class YamlWriter {
+public:
+    static const int DEFAULT_CAPACITY = 64 * 1024;
+
+    explicit YamlWriter(QIODevice* device = nullptr, int capacity = DEFAULT_CAPACITY);
+    ~YamlWriter(); // Flushes to the device, if any
+
+    YamlWriter& write(const char* text);
+    YamlWriter& write(const char* data, int size);
+    YamlWriter& write(const QByteArray& bytes) { return write(bytes.constData(), bytes.size()); }
+    YamlWriter& write(const QString& text) { return write(text.toUtf8()); } // UTF-8
+    // Same bytes as QString::number(value, 'g', 10)
+    YamlWriter& writeNumber(double value);
+
+    // Writes the buffered bytes to the device; false on a write error
+    bool flush();
+    bool hasError() const { return m_error; }
+    // In-memory mode: returns the written bytes and empties the writer
+    QByteArray takeBuffer();
+
+private:
+    void makeRoom(int bytes);
+    inline void reserve(int bytes) { if (m_size + bytes > m_buffer.size()) makeRoom(bytes); }
+
+    QIODevice* m_device;
+    QByteArray m_buffer; // Reused storage; only the first m_size bytes are valid
+    char* m_data;        // m_buffer.data(), cached to avoid detach checks
+    int m_size = 0;
+    bool m_error = false;
+};
@@ -0,0 +1,184 @@
+// motion_export: headless batch exporter (QtCore only).
+// Samples every motor of each given document (*.yaml, *.mpb) and writes a
+// YAML or CSV file per document, exporting several documents in parallel.
+#include "core/documentio.h"
+#include "core/sampleexporter.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QHash>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <qmath.h> // qMax
+
+struct ExportOutcome {
+    bool ok = false;
+    QString message;
+    QStringList warnings; // Exported anyway: skipped YAML lines, motors above their max slope
+};
+
+// Reads one document and writes its samples to 'output' (runs on the job pool)
+static ExportOutcome exportDocument(const QString& input, const QString& output, const QString& id,
+                                    bool hasEndTime, SampleExportSettings settings) {
+    ExportOutcome outcome;
+    DocumentReadResult document = readDocumentFile(input, isBinaryDocumentFile(input));
+    if (document.status != DocumentReadStatus::Ok) {
+        outcome.message = input + ": " + document.errorString;
+        return outcome;
+    }
+    for (const QString& warning : qAsConst(document.warnings)) outcome.warnings.append(input + ":" + warning);
+    QVector<SampleExportMotor> motors = collectExportMotors(document.data);
+    if (!hasEndTime) settings.endTimeMs = defaultExportEndTime(motors);
+    if (exportSampleCount(settings) == 0) {
+        outcome.message = input + ": too many samples per motor at this rate and end time";
+        return outcome;
+    }
+    for (int i = 0; i < motors.size(); ++i) {
+        const ProfileSampler& sampler = motors[i].sampler;
+        const double maxSlope = document.data.motors[i].maxSlope;
+        const int violations = countSlopeViolations(
+            buildSegmentDerivatives(sampler.nodes(), sampler.mode(), sampler.polynomials()), maxSlope);
+        if (violations > 0) {
+            outcome.warnings.append(QString("%1: motor '%2' exceeds its max slope (%3) in %4 segments")
+                .arg(input, document.data.motors[i].name).arg(maxSlope).arg(violations));
+        }
+    }
+    QString fileId = !id.isEmpty() ? id : (!document.data.id.isEmpty() ? document.data.id : QString("default_id"));
+
+    SampleExportResult result = exportSamplesToFile(output, fileId, motors, settings);
+    if (result.status != SampleExportStatus::Ok) {
+        outcome.message = output + ": " + result.errorString;
+        return outcome;
+    }
+    outcome.ok = true;
+    outcome.message = QString("%1 -> %2 (%3 motors, %4 samples each)")
+        .arg(input, output).arg(motors.size()).arg(exportSampleCount(settings));
+    return outcome;
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("motion_export");
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exports sampled motion profiles from motion documents.");
+    parser.addHelpOption();
+    QCommandLineOption rateOption(QStringList{ "r", "rate" }, "Sample rate in Hz (default 100).", "hz", "100");
+    QCommandLineOption endOption(QStringList{ "e", "end" },
+        "End time in ms (default: last node of the longest motor, at least 2000).", "ms");
+    QCommandLineOption formatOption(QStringList{ "f", "format" }, "Output format: yaml or csv (default yaml).",
+                                    "format", "yaml");
+    QCommandLineOption outputOption(QStringList{ "o", "output-dir" },
+        "Directory for the output files (default: next to each input).", "dir");
+    QCommandLineOption jobsOption(QStringList{ "j", "jobs" }, "Documents exported in parallel (default: one per core).", "n");
+    QCommandLineOption idOption("id", "ID written to YAML files (default: the document's own id).", "id");
+    parser.addOption(rateOption);
+    parser.addOption(endOption);
+    parser.addOption(formatOption);
+    parser.addOption(outputOption);
+    parser.addOption(jobsOption);
+    parser.addOption(idOption);
+    parser.addPositionalArgument("files", "Motion documents (*.yaml, *.mpb).", "files...");
+    parser.process(app);
+
+    SampleExportSettings settings;
+    bool ok = true;
+    settings.sampleRateHz = parser.value(rateOption).toDouble(&ok);
+    if (!ok || settings.sampleRateHz <= 0) {
+        err << "Invalid sample rate: " << parser.value(rateOption) << "\n";
+        return 2;
+    }
+    const bool hasEndTime = parser.isSet(endOption);
+    if (hasEndTime) {
+        settings.endTimeMs = parser.value(endOption).toDouble(&ok);
+        if (!ok || settings.endTimeMs < 0) {
+            err << "Invalid end time: " << parser.value(endOption) << "\n";
+            return 2;
+        }
+    }
+    if (hasEndTime && exportSampleCount(settings) == 0) {
+        err << "Too many samples per motor: " << parser.value(endOption) << " ms at "
+            << parser.value(rateOption) << " Hz\n";
+        return 2;
+    }
+    const QString format = parser.value(formatOption).toLower();
+    if (format == "csv") {
+        settings.format = SampleExportFormat::Csv;
+    } else if (format != "yaml") {
+        err << "Unknown format: " << parser.value(formatOption) << " (expected yaml or csv)\n";
+        return 2;
+    }
+    int jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOption)) {
+        jobs = parser.value(jobsOption).toInt(&ok);
+        if (!ok || jobs < 1) {
+            err << "Invalid job count: " << parser.value(jobsOption) << "\n";
+            return 2;
+        }
+    }
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) parser.showHelp(2); // Exits
+    QDir outputDir;
+    if (parser.isSet(outputOption)) {
+        outputDir = QDir(parser.value(outputOption));
+        if (!outputDir.mkpath(".")) {
+            err << "Cannot create output directory: " << parser.value(outputOption) << "\n";
+            return 2;
+        }
+    }
+
+    // Documents run on their own pool; each export formats on a private pool,
+    // so split the cores between them instead of oversubscribing
+    QThreadPool jobPool;
+    jobPool.setMaxThreadCount(jobs);
+    settings.maxThreads = qMax(1, QThread::idealThreadCount() / jobs);
+
+    // Output names come from the input base names, so inputs like a.yaml and
+    // a.mpb (or d1/x.yaml and d2/x.yaml with -o) would write the same file
+    // from two jobs at once: refuse before anything is written
+    const QString suffix = settings.format == SampleExportFormat::Csv ? "csv" : "yaml";
+    QStringList outputs;
+    QHash<QString, QString> inputByOutput;
+    for (const QString& input : inputs) {
+        QFileInfo info(input);
+        QDir dir = parser.isSet(outputOption) ? outputDir : info.absoluteDir();
+        QString output = dir.filePath(info.completeBaseName() + "_samples." + suffix);
+        QString key = QDir::cleanPath(QFileInfo(output).absoluteFilePath());
+        if (inputByOutput.contains(key)) {
+            err << "Output name collision: " << inputByOutput.value(key) << " and " << input
+                << " would both write " << output << "\n";
+            return 2;
+        }
+        inputByOutput.insert(key, input);
+        outputs.append(output);
+    }
+
+    QVector<QFuture<ExportOutcome>> futures;
+    for (int i = 0; i < inputs.size(); ++i) {
+        futures.append(QtConcurrent::run(&jobPool, exportDocument, inputs[i], outputs[i], parser.value(idOption),
+                                         hasEndTime, settings));
+    }
+
+    // Report in argument order
+    int failed = 0;
+    for (QFuture<ExportOutcome>& future : futures) {
+        ExportOutcome outcome = future.result();
+        for (const QString& warning : outcome.warnings) err << "Warning: " << warning << "\n";
+        if (outcome.ok) {
+            out << outcome.message << "\n";
+        } else {
+            err << "Failed: " << outcome.message << "\n";
+            ++failed;
+        }
+        out.flush();
+        err.flush();
+    }
+    if (failed > 0) err << failed << " of " << inputs.size() << " documents failed.\n";
+    return failed > 0 ? 1 : 0;
+}